@@ -147,6 +147,9 @@ void write_byte(UINT32 byteaddress, UINT8 data);
 void write_word(UINT32 byteaddress, UINT16 data);
 void write_dword(UINT32 byteaddress, UINT32 data);
 
+void read_block(UINT32 byteaddress, void *data, UINT32 length);
+void write_block(UINT32 byteaddress, const void *data, UINT32 length);
+
 UINT8 read_io_byte(UINT32 byteaddress);
 UINT16 read_io_word(UINT32 byteaddress);
 UINT32 read_io_dword(UINT32 byteaddress);
@@ -155,6 +158,19 @@ void write_io_byte(UINT32 byteaddress, UINT8 data);
 void write_io_word(UINT32 byteaddress, UINT16 data);
 void write_io_dword(UINT32 byteaddress, UINT32 data);
 
+// CPU_BUS_SIZE_CHANGE flag : guest physical address is host address (WOW64),
+// memory accesses are done directly and the callback is used for I/O only
+#define CPU_BUS_FLAT_MEMORY	0x1000000
+// CPU_BUS_SIZE_CHANGE flag : the callback accepts accesses of the bus width
+// at any address (x86, x64 and ARM64 hosts), so misaligned accesses on a
+// dword aligned bus are passed through instead of read-merge-write of the
+// neighbouring dwords
+#define CPU_BUS_UNALIGNED	0x2000000
+
+extern UINT8 cpumemflat;
+
+extern void (*i386memblock)(UINT32, UINT32, void *, int);	/* CPU_SET_MACTLFC_BLOCK */
+
 void kbd_reset();
 
 // debugger
@@ -623,12 +623,13 @@ extern "C" {
 typedef void* t_CPU_GET_REGPTR(int);
 typedef int t_CPU_EXECUTE_CC(int);
 typedef void t_CPU_SET_MACTLFC(UINT32(*)(int, int, int));
+typedef void t_CPU_SET_MACTLFC_BLOCK(void(*)(UINT32, UINT32, void*, int));
 typedef void t_CPU_INIT();
 typedef void t_CPU_RESET();
 typedef void t_CPU_BUS_SIZE_CHANGE(int);
 typedef void t_CPU_SWITCH_PM(bool);
-typedef void* t_GET_CPU_exec_1step();
-typedef void t_exec_1step();
+typedef void* t_GET_CPU_exec_allstep();
+typedef void t_exec_allstep();
 typedef UINT64 t_CPU_EXECUTE_INJIT();
 
 extern class memaccessandpt;
@@ -640,8 +641,9 @@ struct {
 	void* np21w;
 	t_CPU_GET_REGPTR* CPU_GET_REGPTR = 0;
 	//t_CPU_EXECUTE_CC* CPU_EXECUTE_CC = 0;
-	t_exec_1step* exec_1step = 0;
+	t_exec_allstep* exec_run = 0;	/* exec_allstep(): runs until remainclock runs out */
 	t_CPU_SET_MACTLFC* CPU_SET_MACTLFC = 0;
+	t_CPU_SET_MACTLFC_BLOCK* CPU_SET_MACTLFC_BLOCK = 0;
 	t_CPU_INIT* CPU_INIT = 0;
 	t_CPU_RESET* CPU_RESET = 0;
 	t_CPU_BUS_SIZE_CHANGE* CPU_BUS_SIZE_CHANGE = 0;
@@ -736,11 +738,12 @@ BOOL APIENTRY DllMain(HMODULE hModule,
 		emusemaphore[0].CPU_GET_REGPTR = (t_CPU_GET_REGPTR*)GetProcAddress(hModule, (char*)"CPU_GET_REGPTR");
 		//emusemaphore[0].CPU_EXECUTE_CC = (t_CPU_EXECUTE_CC*)GetProcAddress(hModule, (char*)"CPU_EXECUTE_CC_V2");
 		emusemaphore[0].CPU_SET_MACTLFC = (t_CPU_SET_MACTLFC*)GetProcAddress(hModule, (char*)"CPU_SET_MACTLFC");
+		emusemaphore[0].CPU_SET_MACTLFC_BLOCK = (t_CPU_SET_MACTLFC_BLOCK*)GetProcAddress(hModule, (char*)"CPU_SET_MACTLFC_BLOCK");
 		emusemaphore[0].CPU_INIT = (t_CPU_INIT*)GetProcAddress(hModule, (char*)"CPU_INIT");
 		emusemaphore[0].CPU_RESET = (t_CPU_RESET*)GetProcAddress(hModule, (char*)"CPU_RESET");
 		emusemaphore[0].CPU_BUS_SIZE_CHANGE = (t_CPU_BUS_SIZE_CHANGE*)GetProcAddress(hModule, (char*)"CPU_BUS_SIZE_CHANGE");
 		emusemaphore[0].CPU_SWITCH_PM = (t_CPU_SWITCH_PM*)GetProcAddress(hModule, (char*)"CPU_SWITCH_PM");
-		emusemaphore[0].exec_1step = (t_exec_1step*)(((t_GET_CPU_exec_1step*)GetProcAddress(hModule, (char*)"GET_CPU_exec_1step"))());
+		emusemaphore[0].exec_run = (t_exec_allstep*)(((t_GET_CPU_exec_allstep*)GetProcAddress(hModule, (char*)"GET_CPU_exec_allstep"))());
 		emusemaphore[0].CPU_EXECUTE_INJIT = (t_CPU_EXECUTE_INJIT*)GetProcAddress(hModule, (char*)"CPU_EXECUTE_INJIT");
 		emusemaphore[0].notfirsttime = false;
 		emusemaphore[0].funcofmemaccess = 0;
@@ -751,11 +754,12 @@ BOOL APIENTRY DllMain(HMODULE hModule,
 			emusemaphore[i].CPU_GET_REGPTR = (t_CPU_GET_REGPTR*)ULGetProcAddress((char*)emusemaphore[i].np21w,(char*) "CPU_GET_REGPTR");
 			//emusemaphore[i].CPU_EXECUTE_CC = (t_CPU_EXECUTE_CC*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_EXECUTE_CC_V2");
 			emusemaphore[i].CPU_SET_MACTLFC = (t_CPU_SET_MACTLFC*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_SET_MACTLFC");
+			emusemaphore[i].CPU_SET_MACTLFC_BLOCK = (t_CPU_SET_MACTLFC_BLOCK*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_SET_MACTLFC_BLOCK");
 			emusemaphore[i].CPU_INIT = (t_CPU_INIT*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_INIT");
 			emusemaphore[i].CPU_RESET = (t_CPU_RESET*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_RESET");
 			emusemaphore[i].CPU_BUS_SIZE_CHANGE = (t_CPU_BUS_SIZE_CHANGE*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_BUS_SIZE_CHANGE");
 			emusemaphore[i].CPU_SWITCH_PM = (t_CPU_SWITCH_PM*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_SWITCH_PM");
-			emusemaphore[i].exec_1step = (t_exec_1step*)(((t_GET_CPU_exec_1step*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"GET_CPU_exec_1step"))());
+			emusemaphore[i].exec_run = (t_exec_allstep*)(((t_GET_CPU_exec_allstep*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"GET_CPU_exec_allstep"))());
 			emusemaphore[i].CPU_EXECUTE_INJIT = (t_CPU_EXECUTE_INJIT*)ULGetProcAddress((char*)emusemaphore[i].np21w, (char*)"CPU_EXECUTE_INJIT");
 			emusemaphore[i].notfirsttime = false;
 			emusemaphore[i].funcofmemaccess = 0;
@@ -1115,8 +1119,13 @@ public:
 			this->i386core->s.cpu_stat.sreg[CPU_FS_INDEX].d = 1;
 			this->i386core->s.cpu_stat.sreg[CPU_GS_INDEX].d = 1;
 
+			for (int i = 0; i < CPU_SEGREG_NUM; i++) {
+				SEG_UPDATE_FLAT(&this->i386core->s.cpu_stat.sreg[i]);
+			}
+
 			this->i386core->s.cpu_stat.protected_mode = 1;
 			this->i386core->s.cpu_stat.ss_32 = 1;
+			this->i386core->s.cpu_stat.ss_flat32 = SEG_IS_FLAT(&this->i386core->s.cpu_stat.sreg[CPU_SS_INDEX]) ? 1 : 0;
 			this->i386core->s.cpu_inst.op_32 = 1;
 			this->i386core->s.cpu_inst.as_32 = 1;
 			this->i386core->s.cpu_inst_default.op_32 = 1;
@@ -1281,6 +1290,14 @@ public:
 		}
 		return 0;
 	}
+	static void i386memblock(UINT32 prm_0, UINT32 prm_1, void* prm_2, int prm_3) {
+		if (prm_3 & 1) {
+			memcpy(prm_2, ULongToPtr(prm_0), prm_1);
+		}
+		else {
+			memcpy(ULongToPtr(prm_0), prm_2, prm_1);
+		}
+	}
 };
 
 #ifdef __cplusplus
@@ -1297,12 +1314,13 @@ extern "C" {
 		t_CPU_GET_REGPTR* CPU_GET_REGPTR = 0;
 		//t_CPU_EXECUTE_CC* CPU_EXECUTE_CC = 0;
 		t_CPU_SET_MACTLFC* CPU_SET_MACTLFC = 0;
+		t_CPU_SET_MACTLFC_BLOCK* CPU_SET_MACTLFC_BLOCK = 0;
 		t_CPU_INIT* CPU_INIT = 0;
 		t_CPU_RESET* CPU_RESET = 0;
 		t_CPU_BUS_SIZE_CHANGE* CPU_BUS_SIZE_CHANGE = 0;
 		t_CPU_SWITCH_PM* CPU_SWITCH_PM = 0;
 		//t_GET_CPU_exec_1step* GET_CPU_exec_1step = 0;
-		t_exec_1step* exec_1step = 0;
+		t_exec_allstep* exec_run = 0;
 		t_CPU_EXECUTE_INJIT* CPU_EXECUTE_INJIT = 0;
 
 		I386_CONTEXT* wow_context;
@@ -1335,17 +1353,18 @@ extern "C" {
 				CPU_GET_REGPTR = emusemaphore[EMU_ID].CPU_GET_REGPTR;
 				//CPU_EXECUTE_CC = emusemaphore[EMU_ID].CPU_EXECUTE_CC;
 				CPU_SET_MACTLFC = emusemaphore[EMU_ID].CPU_SET_MACTLFC;
+				CPU_SET_MACTLFC_BLOCK = emusemaphore[EMU_ID].CPU_SET_MACTLFC_BLOCK;
 				CPU_INIT = emusemaphore[EMU_ID].CPU_INIT;
 				CPU_RESET = emusemaphore[EMU_ID].CPU_RESET;
 				CPU_BUS_SIZE_CHANGE = emusemaphore[EMU_ID].CPU_BUS_SIZE_CHANGE;
 				CPU_SWITCH_PM = emusemaphore[EMU_ID].CPU_SWITCH_PM;
 				//GET_CPU_exec_1step = emusemaphore[EMU_ID].GET_CPU_exec_1step;
-				exec_1step = emusemaphore[EMU_ID].exec_1step;
+				exec_run = emusemaphore[EMU_ID].exec_run;
 				CPU_EXECUTE_INJIT = emusemaphore[EMU_ID].CPU_EXECUTE_INJIT;
 				if (emusemaphore[EMU_ID].notfirsttime == false) {
 					CPU_INIT();
 					CPU_RESET();
-					CPU_BUS_SIZE_CHANGE(0x202);
+					CPU_BUS_SIZE_CHANGE(0x202 | CPU_BUS_FLAT_MEMORY);
 					emusemaphore[EMU_ID].memtmp = new memaccessandpt;
 					CPU_SWITCH_PM(1);
 					emusemaphore[EMU_ID].notfirsttime = true;
@@ -1356,8 +1375,9 @@ extern "C" {
 			else {
 				CPU_GET_REGPTR = (t_CPU_GET_REGPTR*)ULGetProcAddress((char*)HM, (char*)"CPU_GET_REGPTR");
 				//CPU_EXECUTE_CC = (t_CPU_EXECUTE_CC*)ULGetProcAddress((char*)HM, (char*)"CPU_EXECUTE_CC_V2");
-				exec_1step = (t_exec_1step*)(((t_GET_CPU_exec_1step*)ULGetProcAddress((char*)HM, (char*)"GET_CPU_exec_1step"))());
+				exec_run = (t_exec_allstep*)(((t_GET_CPU_exec_allstep*)ULGetProcAddress((char*)HM, (char*)"GET_CPU_exec_allstep"))());
 				CPU_SET_MACTLFC = (t_CPU_SET_MACTLFC*)ULGetProcAddress((char*)HM, (char*)"CPU_SET_MACTLFC");
+				CPU_SET_MACTLFC_BLOCK = (t_CPU_SET_MACTLFC_BLOCK*)ULGetProcAddress((char*)HM, (char*)"CPU_SET_MACTLFC_BLOCK");
 				CPU_INIT = (t_CPU_INIT*)ULGetProcAddress((char*)HM, (char*)"CPU_INIT");
 				CPU_RESET = (t_CPU_RESET*)ULGetProcAddress((char*)HM, (char*)"CPU_RESET");
 				CPU_BUS_SIZE_CHANGE = (t_CPU_BUS_SIZE_CHANGE*)ULGetProcAddress((char*)HM, (char*)"CPU_BUS_SIZE_CHANGE");
@@ -1365,7 +1385,7 @@ extern "C" {
 				CPU_EXECUTE_INJIT = (t_CPU_EXECUTE_INJIT*)ULGetProcAddress((char*)HM, (char*)"CPU_EXECUTE_INJIT");
 				CPU_INIT();
 				CPU_RESET();
-				CPU_BUS_SIZE_CHANGE(0x202);
+				CPU_BUS_SIZE_CHANGE(0x202 | CPU_BUS_FLAT_MEMORY);
 				memtmp = new memaccessandpt;
 				CPU_SWITCH_PM(1);
 				memtmp->i386core = (I386CORE*)CPU_GET_REGPTR(5);
@@ -1470,6 +1490,7 @@ extern "C" {
 				FlushInstructionCache(GetCurrentProcess(), funcofmemaccess, sizeof(memaccess));
 				if (EMU_ID != -1) { emusemaphore[EMU_ID].funcofmemaccess = funcofmemaccess; }
 				CPU_SET_MACTLFC((UINT32(*)(int, int, int))funcofmemaccess);
+				CPU_SET_MACTLFC_BLOCK(memaccessandpt::i386memblock);
 			}
 		}
 		memtmp->i386finish = false;
@@ -1479,7 +1500,7 @@ extern "C" {
 		//memtmp->setntc(wow_context);
 		//while (memtmp->i386finish == false) { memtmp->i386core->s.remainclock = 200000000; while ((memtmp->i386finish == false) && ((memtmp->i386core->s.remainclock) > 0)) { exec_1step(); } }
 		if (jit_enabled == false) {
-			while (memtmp->i386finish == false) { memtmp->i386core->s.remainclock = 0x7fffffff; while ((memtmp->i386finish == false) && ((memtmp->i386core->s.remainclock) > 0)) { exec_1step(); } }
+			while (memtmp->i386finish == false) { memtmp->i386core->s.remainclock = 0x7fffffff; while ((memtmp->i386finish == false) && ((memtmp->i386core->s.remainclock) > 0)) { exec_run(); } }
 		}
 		else {
 			while (memtmp->i386finish == false) { memtmp->i386core->s.remainclock = 0x7fffffff; while ((memtmp->i386finish == false) && ((memtmp->i386core->s.remainclock) > 0)) { CPU_EXECUTE_INJIT(); } }
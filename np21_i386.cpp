@@ -1,4 +1,5 @@
 #include "windows.h"
+#include "common.h"
 /*BOOL APIENTRY DllMain (HMODULE hModule,
 	DWORD  ul_reason_for_call,
 	LPVOID lpReserved
@@ -54,6 +55,7 @@ VC_DLL_EXPORTS void CPU_LOAD_LDTR(UINT16 selector);
 VC_DLL_EXPORTS void CPU_LOAD_TR(UINT16 selector);
 VC_DLL_EXPORTS UINT32 CPU_TRANS_PAGING_ADDR(UINT32 addr);
 VC_DLL_EXPORTS void CPU_SET_MACTLFC(UINT32(*ptrformaf) (int, int, int));
+VC_DLL_EXPORTS void CPU_SET_MACTLFC_BLOCK(void(*ptrformbf) (UINT32, UINT32, void *, int));
 VC_DLL_EXPORTS UINT32 CPU_GET_REG(int regid);
 VC_DLL_EXPORTS void CPU_SET_REG(int regid, UINT32 regdata);
 VC_DLL_EXPORTS void CPU_SET_IRQ(BOOL statforirq);
@@ -109,118 +111,270 @@ void CPU_SET_MACTLFC(UINT32 (*ptrformaf) (int, int, int))
 	i386memaccess = ptrformaf;
 }
 
-int cpubussize = 0;
+/* block transfer : (address, length, buffer, direction 0 = write / 1 = read) */
+void(*i386memblock) (UINT32, UINT32, void *, int);
 
-void CPU_BUS_SIZE_CHANGE(int size) {
-	cpubussize = size;
+void CPU_SET_MACTLFC_BLOCK(void (*ptrformbf) (UINT32, UINT32, void *, int))
+{
+	i386memblock = ptrformbf;
 }
 
-
-UINT8 read_byte(UINT32 byteaddress)
-{
-	if (((cpubussize >> 16) & 0xF) == 0) {
-		return ((i386memaccess(((int)byteaddress) + 0, 0, 1) & 0xFF) << (8 * 0));
+int cpubussize = 0;
+UINT8 cpumemflat = 0;
+
+/* flat identity memory : guest physical address == host address */
+#define FLATMEM(type, addr)	(*(type *)(uintptr_t)(UINT32)(addr))
+
+/*
+ * memory bus accessors, specialized on bus configuration
+ *  FLAT    : CPU_BUS_FLAT_MEMORY
+ *  ALIGNED : (cpubussize >> 16) & 0xF, dword aligned bus
+ *            (not with CPU_BUS_UNALIGNED, which passes accesses through)
+ *  WIDTH   : cpubussize & 0xFF, 0 = 8bit, 1 = 16bit, 2 = 32bit
+ */
+template <int FLAT, int ALIGNED, int WIDTH>
+struct i386membus {
+	static UINT8 read_byte(UINT32 byteaddress)
+	{
+		if (FLAT) {
+			return FLATMEM(UINT8, byteaddress);
+		}
+		if (!ALIGNED) {
+			return ((i386memaccess(((int)byteaddress) + 0, 0, 1) & 0xFF) << (8 * 0));
+		}
+		else {
+			return ((i386memaccess(((int)byteaddress) + 0, 0, 1) >> (8 * (byteaddress & 3))) & 0xFF);
+		}
 	}
-	else {
-		return ((i386memaccess(((int)byteaddress) + 0, 0, 1) >> (8 * (byteaddress & 3))) & 0xFF);
+	static UINT16 read_word(UINT32 byteaddress)
+	{
+		if (FLAT) {
+			return FLATMEM(UINT16, byteaddress);
+		}
+		if (!ALIGNED) {
+			if (WIDTH == 0) {
+				return ((i386memaccess(((int)byteaddress) + 0, 0, 1) & 0xFF) << (8 * 0)) | ((i386memaccess(((int)byteaddress) + 1, 0, 1) & 0xFF) << (8 * 1));
+			}
+			else {
+				return ((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) & 0xFFFF) << (16 * 0));
+			}
+		}
+		else {
+			if ((byteaddress & 3) == 3) {
+				return ((((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) >> (8 * 3)) & 0xFF) | ((i386memaccess(((int)byteaddress) + 1, 0, 1 | 0x10) << (8 * 1)) & 0xFF00)) & 0xFFFF);
+			}
+			else {
+				return ((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) >> (8 * (byteaddress & 3))) & 0xFFFF);
+			}
+		}
 	}
-}
-UINT16 read_word(UINT32 byteaddress)
-{
-	if (((cpubussize >> 16) & 0xF) == 0) {
-		if (((cpubussize >> 0) & 0xFF) == 0) {
-			return ((i386memaccess(((int)byteaddress) + 0, 0, 1) & 0xFF) << (8 * 0)) | ((i386memaccess(((int)byteaddress) + 1, 0, 1) & 0xFF) << (8 * 1));
+	static UINT32 read_dword(UINT32 byteaddress)
+	{
+		if (FLAT) {
+			return FLATMEM(UINT32, byteaddress);
 		}
-		else if (((cpubussize >> 0) & 0xFF) >= 1) {
-			return ((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) & 0xFFFF) << (16 * 0));
+		if (!ALIGNED) {
+			if (WIDTH == 0) {
+				return ((i386memaccess(((int)byteaddress) + 0, 0, 1) & 0xFF) << (8 * 0)) | ((i386memaccess(((int)byteaddress) + 1, 0, 1) & 0xFF) << (8 * 1)) | ((i386memaccess(((int)byteaddress) + 2, 0, 1) & 0xFF) << (8 * 2)) | ((i386memaccess(((int)byteaddress) + 3, 0, 1) & 0xFF) << (8 * 3));
+			}
+			else if (WIDTH == 1) {
+				return ((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) & 0xFFFF) << (16 * 0)) | ((i386memaccess(((int)byteaddress) + 2, 0, 1 | 0x10) & 0xFFFF) << (16 * 1));
+			}
+			else {
+				return i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x20);
+			}
+		}
+		else {
+			if ((byteaddress & 3) == 0) {
+				return i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x20);
+			}
+			else {
+				return (((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x20)>>(8 * (byteaddress & 3)))&((1<<(8 * (byteaddress & 3)))-1))|(((i386memaccess(((int)byteaddress) + 4, 0, 1 | 0x20)>>(8 * 0))&((1<<(8 * (4-(byteaddress & 3))))-1))<<(8 * (byteaddress & 3))))&0xFFFFFFFF;
+			}
 		}
 	}
-	else {
-		if ((byteaddress & 3) == 3) { 
-			return ((((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) >> (8 * 3)) & 0xFF) | ((i386memaccess(((int)byteaddress) + 1, 0, 1 | 0x10) << (8 * 1)) & 0xFF00)) & 0xFFFF);
+
+	static void write_byte(UINT32 byteaddress, UINT8 data)
+	{
+		if (FLAT) {
+			FLATMEM(UINT8, byteaddress) = data;
+			return;
+		}
+		if (!ALIGNED) {
+			i386memaccess(((int)byteaddress) + 0, (UINT8)data, 0);
 		}
 		else {
-			return ((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) >> (8 * (byteaddress & 3))) & 0xFFFF);
+			i386memaccess(((int)byteaddress) + 0, (read_dword(byteaddress&0xFFFFFFFC)&(~(0xFF<<(8*(byteaddress&3)))))|(((UINT8)data)<<(8*(byteaddress&3))), 0);
 		}
 	}
-}
-UINT32 read_dword(UINT32 byteaddress)
-{
-	if (((cpubussize >> 16) & 0xF) == 0) {
-		if (((cpubussize >> 0) & 0xFF) == 0) {
-			return ((i386memaccess(((int)byteaddress) + 0, 0, 1) & 0xFF) << (8 * 0)) | ((i386memaccess(((int)byteaddress) + 1, 0, 1) & 0xFF) << (8 * 1)) | ((i386memaccess(((int)byteaddress) + 2, 0, 1) & 0xFF) << (8 * 2)) | ((i386memaccess(((int)byteaddress) + 3, 0, 1) & 0xFF) << (8 * 3));
+	static void write_word(UINT32 byteaddress, UINT16 data)
+	{
+		if (FLAT) {
+			FLATMEM(UINT16, byteaddress) = data;
+			return;
 		}
-		else if (((cpubussize >> 0) & 0xFF) == 1) {
-			return ((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x10) & 0xFFFF) << (16 * 0)) | ((i386memaccess(((int)byteaddress) + 2, 0, 1 | 0x10) & 0xFFFF) << (16 * 1));
+		if (!ALIGNED) {
+			if (WIDTH == 0) {
+				i386memaccess(((int)byteaddress) + 0, (UINT8)(data >> (8 * 0)), 0);
+				i386memaccess(((int)byteaddress) + 1, (UINT8)(data >> (8 * 1)), 0);
+			}
+			else {
+				i386memaccess(((int)byteaddress) + 0, (data >> (16 * 0)), 0 | 0x10);
+			}
 		}
-		else if (((cpubussize >> 0) & 0xFF) >= 2) {
-			return i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x20);
+		else {
+			if ((byteaddress & 3) == 3) {
+				i386memaccess(((int)byteaddress) + 0, (read_dword(byteaddress&0xFFFFFFFC)&(~(0xFF<<(8*(byteaddress&3)))))|((data << (8 * 3))&0xFF000000), 0 | 0x10);
+				i386memaccess(((int)byteaddress) + 1, (read_dword((byteaddress+1)&0xFFFFFFFC)&(~(0xFF<<(8*0))))|((data >> (8 * 1))&0xFF), 0 | 0x10);
+			}
+			else {
+				i386memaccess(((int)byteaddress) + 0, (read_dword(byteaddress&0xFFFFFFFC)&(~(0xFFFF<<(8*(byteaddress&3)))))|(data << (8 * (byteaddress&3))), 0 | 0x10);
+			}
 		}
 	}
-	else {
-		if ((byteaddress & 3) == 0) {
-			return i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x20);
+	static void write_dword(UINT32 byteaddress, UINT32 data)
+	{
+		if (FLAT) {
+			FLATMEM(UINT32, byteaddress) = data;
+			return;
+		}
+		if (!ALIGNED) {
+			if (WIDTH == 0) {
+				i386memaccess(((int)byteaddress) + 0, (UINT8)(data >> (8 * 0)), 0);
+				i386memaccess(((int)byteaddress) + 1, (UINT8)(data >> (8 * 1)), 0);
+				i386memaccess(((int)byteaddress) + 2, (UINT8)(data >> (8 * 2)), 0);
+				i386memaccess(((int)byteaddress) + 3, (UINT8)(data >> (8 * 3)), 0);
+			}
+			else if (WIDTH == 1) {
+				i386memaccess(((int)byteaddress) + 0, (data >> (16 * 0)), 0 | 0x10);
+				i386memaccess(((int)byteaddress) + 2, (data >> (16 * 1)), 0 | 0x10);
+			}
+			else {
+				i386memaccess(((int)byteaddress) + 0, (data), 0 | 0x20);
+			}
 		}
 		else {
-			return (((i386memaccess(((int)byteaddress) + 0, 0, 1 | 0x20)>>(8 * (byteaddress & 3)))&((1<<(8 * (byteaddress & 3)))-1))|(((i386memaccess(((int)byteaddress) + 4, 0, 1 | 0x20)>>(8 * 0))&((1<<(8 * (4-(byteaddress & 3))))-1))<<(8 * (byteaddress & 3))))&0xFFFFFFFF;
+			if ((byteaddress & 3) == 0) {
+				i386memaccess(((int)byteaddress) + 0, (data), 0 | 0x20);
+			}
+			else {
+				i386memaccess(((int)byteaddress) + 0, ((read_dword(byteaddress&0xFFFFFFFC)&((1<<(8*(byteaddress&3)))-1))|((data<<(8*(byteaddress & 3)))&(~((1<<(8*(byteaddress & 3)))-1)))), 0 | 0x20);
+				i386memaccess(((int)byteaddress) + 4, ((read_dword((byteaddress+4)&0xFFFFFFFC)&(((1<<(8*(4-(byteaddress&3))))-1)<<(8*(byteaddress&3))))|((data>>(8*(4-(byteaddress & 3))))&((1<<(8*(byteaddress & 3)))-1))), 0 | 0x20);
+			}
 		}
 	}
+};
+
+/* active accessor set, selected by CPU_BUS_SIZE_CHANGE */
+static struct {
+	UINT8 (*read_byte)(UINT32 byteaddress);
+	UINT16 (*read_word)(UINT32 byteaddress);
+	UINT32 (*read_dword)(UINT32 byteaddress);
+	void (*write_byte)(UINT32 byteaddress, UINT8 data);
+	void (*write_word)(UINT32 byteaddress, UINT16 data);
+	void (*write_dword)(UINT32 byteaddress, UINT32 data);
+} membus = {
+	i386membus<0, 0, 0>::read_byte,
+	i386membus<0, 0, 0>::read_word,
+	i386membus<0, 0, 0>::read_dword,
+	i386membus<0, 0, 0>::write_byte,
+	i386membus<0, 0, 0>::write_word,
+	i386membus<0, 0, 0>::write_dword,
+};
+
+template <int FLAT, int ALIGNED, int WIDTH>
+static void membus_select(void)
+{
+	membus.read_byte = i386membus<FLAT, ALIGNED, WIDTH>::read_byte;
+	membus.read_word = i386membus<FLAT, ALIGNED, WIDTH>::read_word;
+	membus.read_dword = i386membus<FLAT, ALIGNED, WIDTH>::read_dword;
+	membus.write_byte = i386membus<FLAT, ALIGNED, WIDTH>::write_byte;
+	membus.write_word = i386membus<FLAT, ALIGNED, WIDTH>::write_word;
+	membus.write_dword = i386membus<FLAT, ALIGNED, WIDTH>::write_dword;
 }
 
-void write_byte(UINT32 byteaddress, UINT8 data)
-{
-	if (((cpubussize >> 16) & 0xF) == 0) {
-		i386memaccess(((int)byteaddress) + 0, (UINT8)data, 0);
+void CPU_BUS_SIZE_CHANGE(int size) {
+	cpubussize = size;
+	cpumemflat = (size & CPU_BUS_FLAT_MEMORY) ? 1 : 0;
+
+	if (cpumemflat) {
+		membus_select<1, 0, 0>();
+	}
+	else if ((((cpubussize >> 16) & 0xF) != 0) && !(cpubussize & CPU_BUS_UNALIGNED)) {
+		membus_select<0, 1, 0>();
 	}
 	else {
-		i386memaccess(((int)byteaddress) + 0, (read_dword(byteaddress&0xFFFFFFFC)&(~(0xFF<<(8*(byteaddress&3)))))|(((UINT8)data)<<(8*(byteaddress&3))), 0);
+		/* CPU_BUS_UNALIGNED: one access of the bus width, whatever the alignment */
+		switch (cpubussize & 0xFF) {
+		case 0:
+			membus_select<0, 0, 0>();
+			break;
+		case 1:
+			membus_select<0, 0, 1>();
+			break;
+		default:
+			membus_select<0, 0, 2>();
+			break;
+		}
 	}
 }
+
+
+UINT8 read_byte(UINT32 byteaddress)
+{
+	return membus.read_byte(byteaddress);
+}
+UINT16 read_word(UINT32 byteaddress)
+{
+	return membus.read_word(byteaddress);
+}
+UINT32 read_dword(UINT32 byteaddress)
+{
+	return membus.read_dword(byteaddress);
+}
+
+void write_byte(UINT32 byteaddress, UINT8 data)
+{
+	membus.write_byte(byteaddress, data);
+}
 void write_word(UINT32 byteaddress, UINT16 data)
 {
-	if (((cpubussize >> 16) & 0xF) == 0) {
-		if (((cpubussize >> 0) & 0xFF) == 0) {
-		i386memaccess(((int)byteaddress) + 0, (UINT8)(data >> (8 * 0)), 0);
-		i386memaccess(((int)byteaddress) + 1, (UINT8)(data >> (8 * 1)), 0);
-	}
-	else if (((cpubussize >> 0) & 0xFF) >= 1) {
-		i386memaccess(((int)byteaddress) + 0, (data >> (16 * 0)), 0 | 0x10);
+	membus.write_word(byteaddress, data);
+}
+void write_dword(UINT32 byteaddress, UINT32 data)
+{
+	membus.write_dword(byteaddress, data);
+}
+
+void read_block(UINT32 byteaddress, void *data, UINT32 length)
+{
+	UINT8 *out = (UINT8 *)data;
+
+	if (cpumemflat) {
+		memcpy(out, &FLATMEM(UINT8, byteaddress), length);
 	}
+	else if (i386memblock) {
+		i386memblock(byteaddress, length, out, 1);
 	}
 	else {
-		if ((byteaddress & 3) == 3) {
-			i386memaccess(((int)byteaddress) + 0, (read_dword(byteaddress&0xFFFFFFFC)&(~(0xFF<<(8*(byteaddress&3)))))|((data << (8 * 3))&0xFF000000), 0 | 0x10);
-			i386memaccess(((int)byteaddress) + 1, (read_dword((byteaddress+1)&0xFFFFFFFC)&(~(0xFF<<(8*0))))|((data >> (8 * 1))&0xFF), 0 | 0x10);
-		}
-		else {
-			i386memaccess(((int)byteaddress) + 0, (read_dword(byteaddress&0xFFFFFFFC)&(~(0xFFFF<<(8*(byteaddress&3)))))|(data << (8 * (byteaddress&3))), 0 | 0x10);
+		while (length-- > 0) {
+			*out++ = membus.read_byte(byteaddress++);
 		}
 	}
 }
-void write_dword(UINT32 byteaddress, UINT32 data)
+void write_block(UINT32 byteaddress, const void *data, UINT32 length)
 {
-	if (((cpubussize >> 16) & 0xF) == 0) {
-		if (((cpubussize >> 0) & 0xFF) == 0) {
-			i386memaccess(((int)byteaddress) + 0, (UINT8)(data >> (8 * 0)), 0);
-			i386memaccess(((int)byteaddress) + 1, (UINT8)(data >> (8 * 1)), 0);
-			i386memaccess(((int)byteaddress) + 2, (UINT8)(data >> (8 * 2)), 0);
-			i386memaccess(((int)byteaddress) + 3, (UINT8)(data >> (8 * 3)), 0);
-		}
-		else if (((cpubussize >> 0) & 0xFF) == 1) {
-			i386memaccess(((int)byteaddress) + 0, (data >> (16 * 0)), 0 | 0x10);
-			i386memaccess(((int)byteaddress) + 2, (data >> (16 * 1)), 0 | 0x10);
-		}
-		else if (((cpubussize >> 0) & 0xFF) >= 2) {
-			i386memaccess(((int)byteaddress) + 0, (data), 0 | 0x20);
-		}
+	const UINT8 *in = (const UINT8 *)data;
+
+	if (cpumemflat) {
+		memcpy(&FLATMEM(UINT8, byteaddress), in, length);
+	}
+	else if (i386memblock) {
+		i386memblock(byteaddress, length, (void *)in, 0);
 	}
 	else {
-		if ((byteaddress & 3) == 0) {
-			i386memaccess(((int)byteaddress) + 0, (data), 0 | 0x20);
-		}
-		else {
-			i386memaccess(((int)byteaddress) + 0, ((read_dword(byteaddress&0xFFFFFFFC)&((1<<(8*(byteaddress&3)))-1))|((data<<(8*(byteaddress & 3)))&(~((1<<(8*(byteaddress & 3)))-1)))), 0 | 0x20);
-			i386memaccess(((int)byteaddress) + 4, ((read_dword((byteaddress+4)&0xFFFFFFFC)&(((1<<(8*(4-(byteaddress&3))))-1)<<(8*(byteaddress&3))))|((data>>(8*(4-(byteaddress & 3))))&((1<<(8*(byteaddress & 3)))-1))), 0 | 0x20);
+		while (length-- > 0) {
+			membus.write_byte(byteaddress++, *in++);
 		}
 	}
 }
@@ -388,6 +542,7 @@ void CPU_SWITCH_PM(BOOL onoff)
 		CPU_STATSAVE.cpu_inst_default.op_32 =
 		CPU_STATSAVE.cpu_inst_default.as_32 = 0;
 	CPU_STAT_SS32 = 0;
+	SS_UPDATE_FLAT32();
 	set_cpl(0);
 	CPU_STAT_PM = onoff;
 }
@@ -397,11 +552,13 @@ void CPU_SET_OP32(UINT8 regdata)
 {
 	CPU_INST_OP32 = regdata;
 	CPU_STATSAVE.cpu_inst_default.op_32 = regdata;
+	CPU_STAT_FLAT32 = FLAT32_RECHECK;
 }
 void CPU_SET_AS32(UINT8 regdata)
 {
 	CPU_INST_AS32 = regdata;
 	CPU_STATSAVE.cpu_inst_default.as_32 = regdata;
+	CPU_STAT_FLAT32 = FLAT32_RECHECK;
 }
 
 UINT32 CPU_GET_REG(int regid)
@@ -422,6 +579,9 @@ UINT32 CPU_GET_SYSREG(int regid)
 void CPU_SET_SYSREG(int regid, UINT32 regdata)
 {
 	CPU_STAT_SREGBASE(regid) = regdata;
+	SEG_UPDATE_FLAT(&CPU_STAT_SREG(regid));
+	SS_UPDATE_FLAT32();
+	CPU_CLEARPREFETCH();
 }
 
 UINT32 CPU_GET_SYSREG_DESC(int regid)
@@ -442,6 +602,9 @@ UINT32 CPU_GET_SYSREG_LIMIT(int regid)
 void CPU_SET_SYSREG_LIMIT(int regid, UINT32 regdata)
 {
 	CPU_STAT_SREGLIMIT(regid) = regdata;
+	SEG_UPDATE_FLAT(&CPU_STAT_SREG(regid));
+	SS_UPDATE_FLAT32();
+	CPU_CLEARPREFETCH();
 }
 
 UINT32 CPU__GET_CR0()
@@ -557,11 +720,14 @@ void CPU__SET_MXCSR(UINT32 regdata)
 void CPU_SET_SS32(UINT8 statforsq)
 {
 	CPU_STAT_SS32 = statforsq;
+	SS_UPDATE_FLAT32();
+	CPU_STAT_FLAT32 = FLAT32_RECHECK;
 }
 
 void CPU_SET_PM(UINT8 statforsq)
 {
 	CPU_STAT_PM = statforsq;
+	CPU_CLEARPREFETCH();
 }
 
 
@@ -675,7 +841,7 @@ inline void CPU_SET_CR0(UINT32 src)
 #endif
 	CPU_CR0 = src;
 
-	if ((reg ^ CPU_CR0) & (CPU_CR0_PE|CPU_CR0_PG)) {
+	if ((reg ^ CPU_CR0) & (CPU_CR0_PE|CPU_CR0_PG|CPU_CR0_WP)) {
 		tlb_flush_all();
 	}
 	if ((reg ^ CPU_CR0) & CPU_CR0_PE) {
@@ -1009,7 +1175,11 @@ catch (int e) {
 #endif
 }
 
-extern "C" __declspec(dllexport) void* GET_CPU_exec_1step() { return &exec_1step; }
+/* a host stepping on its own may change the guest state between steps */
+static void exec_1step_host(void) { codecache_flush(); CPU_CLEARPREFETCH(); exec_1step(); }
+
+extern "C" __declspec(dllexport) void* GET_CPU_exec_1step() { return &exec_1step_host; }
+extern "C" __declspec(dllexport) void* GET_CPU_exec_allstep() { return &exec_allstep; }
 
 extern "C" __declspec(dllexport) int CPU_EXECUTE_CC_V2(int clockcount) {
 	CPU_REMCLOCK = CPU_BASECLOCK = clockcount;
@@ -1251,6 +1421,12 @@ void* CPU_GET_REGPTR(int reglno) {
 	case 7:
 		return (&(i386msr));
 		break;
+	case 8:
+		return (&(i386tlbstat));
+		break;
+	case 9:
+		return (&(i386excstat));
+		break;
 	}
 }
 
@@ -1263,6 +1439,8 @@ void CPU_EXECUTE_INFINITY(void) { while (true) { CPU_EXECUTE(); } }
 
 __declspec(dllexport) void CPU_EXECUTE_BY_NUM_OF_INSTS(UINT32 noi4prm_0) {
 	UINT32 noi = noi4prm_0;
+	codecache_flush();
+	CPU_CLEARPREFETCH();	/* the host may have changed guest memory and state */
 	while (noi != 0) { exec_1step(); noi--; }
 }
 
@@ -1271,5 +1449,39 @@ __declspec(dllexport) void CPU_EXECUTE_BY_NUM_OF_INSTS(UINT32 noi4prm_0) {
 //extern UINT32 exec_jit();
 
 extern "C" __declspec(dllexport) UINT64 CPU_EXECUTE_INJIT() {
-	return exec_jit();
+	UINT64 ret;
+
+	codecache_flush();
+	CPU_CLEARPREFETCH();	/* the host may have changed guest memory and state */
+#if defined(USE_EXCEPTION_LONGJMP)
+	jmp_buf jb;
+	jmp_buf *prev = exec_recover;
+
+	/*
+	 * JIT code may call in here while an outer exec_allstep() owns
+	 * exec_recover.  A guest exception ends this run and the next call
+	 * goes on with its handler; the outer buffer is put back on every
+	 * way out, also when a host fault unwinds through this frame.
+	 */
+	exec_recover = &jb;
+#if defined(USE_HOST_FAULT_RECOVERY)
+	__try {
+#endif
+		if (setjmp(jb) == 0) {
+			ret = exec_jit();
+		} else {
+			ret = 0;
+		}
+#if defined(USE_HOST_FAULT_RECOVERY)
+	} __finally {
+		exec_recover = prev;
+	}
+#else
+	exec_recover = prev;
+#endif
+#else
+	ret = exec_jit();
+#endif
+	CPU_LAZYFLAGS_SYNC();
+	return ret;
 }
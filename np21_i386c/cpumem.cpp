@@ -31,6 +31,7 @@ static void trace_fmt_ex(const char *fmt, ...)
 #endif
 
 UINT32 codefetch_address;
+CODEFETCH_WINDOW codefetch_window;
 
 // ----
 REG8 MEMCALL memp_read8(UINT32 address) {
@@ -88,36 +89,42 @@ UINT32 MEMCALL memp_read32_paging(UINT32 address) {
 void MEMCALL memp_write8(UINT32 address, REG8 value) {
 
 	address = address & CPU_ADRSMASK;
+	CODEFETCH_WINDOW_CHECK(address, 1);
 	write_byte(address, value);
 }
 
 void MEMCALL memp_write16(UINT32 address, REG16 value) {
 
 	address = address & CPU_ADRSMASK;
+	CODEFETCH_WINDOW_CHECK(address, 2);
 	write_word(address, value);
 }
 
 void MEMCALL memp_write32(UINT32 address, UINT32 value) {
 
 	address = address & CPU_ADRSMASK;
+	CODEFETCH_WINDOW_CHECK(address, 4);
 	write_dword(address, value);
 }
 
 void MEMCALL memp_write8_paging(UINT32 address, REG8 value) {
 
 	address = address & CPU_ADRSMASK;
+	CODEFETCH_WINDOW_CHECK(address, 1);
 	write_byte(address, value);
 }
 
 void MEMCALL memp_write16_paging(UINT32 address, REG16 value) {
 
 	address = address & CPU_ADRSMASK;
+	CODEFETCH_WINDOW_CHECK(address, 2);
 	write_word(address, value);
 }
 
 void MEMCALL memp_write32_paging(UINT32 address, UINT32 value) {
 
 	address = address & CPU_ADRSMASK;
+	CODEFETCH_WINDOW_CHECK(address, 4);
 	write_dword(address, value);
 }
 
@@ -125,24 +132,60 @@ void MEMCALL memp_write32_paging(UINT32 address, UINT32 value) {
 void MEMCALL memp_reads(UINT32 address, void *dat, UINT leng) {
 
 	UINT8 *out = (UINT8 *)dat;
-	
-	//address = address & CPU_ADRSMASK;
+	UINT	size;
+
+	if (CPU_ADRSMASK != ~(UINT32)0) {
+		/* slow memory access (A20 masked) */
+		while (leng-- > 0) {
+			*out++ = memp_read8(address++);
+		}
+		return;
+	}
 
-	/* slow memory access */
-	while (leng-- > 0) {
-		*out++ = memp_read8(address++);
+	/* block transfer, split at 4GB wrap */
+	while (leng) {
+		size = (UINT)(0 - address);
+		if ((size == 0) || (size > leng)) {
+			size = leng;
+		}
+		read_block(address, out, size);
+		address += size;
+		out += size;
+		leng -= size;
 	}
 }
 
 void MEMCALL memp_writes(UINT32 address, const void *dat, UINT leng) {
 
 	const UINT8 *out = (UINT8 *)dat;
+	UINT	size;
 
-	//address = address & CPU_ADRSMASK;
+	if (((UINT32)(address - codefetch_window.paddr) < codefetch_window.len)
+	 || ((UINT32)(codefetch_window.paddr - address) < leng)) {
+		codefetch_window.len = 0;
+	}
+#if defined(USE_CODE_CACHE)
+	codecache_store(address, leng);
+#endif
+
+	if (CPU_ADRSMASK != ~(UINT32)0) {
+		/* slow memory access (A20 masked) */
+		while (leng-- > 0) {
+			memp_write8(address++, *out++);
+		}
+		return;
+	}
 
-	/* slow memory access */
-	while (leng-- > 0) {
-		memp_write8(address++, *out++);
+	/* block transfer, split at 4GB wrap */
+	while (leng) {
+		size = (UINT)(0 - address);
+		if ((size == 0) || (size > leng)) {
+			size = leng;
+		}
+		write_block(address, out, size);
+		address += size;
+		out += size;
+		leng -= size;
 	}
 }
 
@@ -320,33 +363,51 @@ void MEMCALL memr_writes(UINT seg, UINT off, const void *dat, UINT leng) {
 	}
 }
 
+// ---- I/O
+// port handlers (the BOP in particular) run host code that may rewrite
+// guest memory behind the CPU, so the fetch window is dropped first.
+// They also read and write the guest registers, so the lazy flags are
+// folded into EFLAGS before they run.
+
 void IOOUTCALL iocore_out8(UINT port, REG8 dat)
 {
+	CPU_CLEARPREFETCH();
+	CPU_LAZYFLAGS_SYNC();
 	write_io_byte(port, dat);
 }
 
 REG8 IOINPCALL iocore_inp8(UINT port)
 {
+	CPU_CLEARPREFETCH();
+	CPU_LAZYFLAGS_SYNC();
 	return read_io_byte(port);
 }
 
 void IOOUTCALL iocore_out16(UINT port, REG16 dat)
 {
+	CPU_CLEARPREFETCH();
+	CPU_LAZYFLAGS_SYNC();
 	write_io_word(port, dat);
 }
 
 REG16 IOINPCALL iocore_inp16(UINT port)
 {
+	CPU_CLEARPREFETCH();
+	CPU_LAZYFLAGS_SYNC();
 	return read_io_word(port);
 }
 
 void IOOUTCALL iocore_out32(UINT port, UINT32 dat)
 {
+	CPU_CLEARPREFETCH();
+	CPU_LAZYFLAGS_SYNC();
 	write_io_dword(port, dat);
 }
 
 UINT32 IOINPCALL iocore_inp32(UINT port)
 {
+	CPU_CLEARPREFETCH();
+	CPU_LAZYFLAGS_SYNC();
 	return read_io_dword(port);
 }
 
@@ -66,6 +66,159 @@ void dmax86(void);
 //#endif
 
 
+// ---- Flat identity memory (CPU_BUS_FLAT_MEMORY)
+
+extern UINT32 codefetch_address;
+
+#define	MEMF_PTR(type, addr)	((type *)(uintptr_t)(UINT32)(addr))
+
+/*
+ * instruction fetch window
+ *
+ * cpu_codefetch*() serve opcode bytes out of ptr[] while the linear
+ * address stays inside [laddr, laddr + len).  The window never crosses
+ * a page boundary or the CS limit, so one physical span backs it.
+ * ptr is buf[], or with USE_CODE_CACHE the rest of the code page: the
+ * guest memory itself on the flat bus, a code cache page otherwise.
+ * len = 0 means empty.
+ */
+#define	CODEFETCH_WINDOW_SIZE	32
+
+typedef struct {
+	UINT32	laddr;	/* linear address of ptr[0] */
+	UINT32	paddr;	/* physical address of ptr[0] */
+	UINT	len;	/* valid bytes in ptr */
+	const UINT8	*ptr;
+	UINT8	buf[CODEFETCH_WINDOW_SIZE];
+} CODEFETCH_WINDOW;
+
+extern CODEFETCH_WINDOW codefetch_window;
+
+#if defined(USE_CODE_CACHE)
+/*
+ * code page cache
+ *
+ * Off the flat bus, hot code pages are copied whole and the fetch
+ * window runs over the copy.  codecache_map[] has a bit per physical
+ * page held; a store to such a page drops the copy.
+ */
+extern UINT8 codecache_map[0x100000 / 8];
+
+void MEMCALL codecache_store(UINT32 addr, UINT size);
+void codecache_flush(void);
+
+#define	CODECACHE_CHECK(addr, size) \
+do { \
+	if (codecache_map[(addr) >> 15] \
+	  | codecache_map[(UINT32)((addr) + ((size) - 1)) >> 15]) { \
+		codecache_store((addr), (size)); \
+	} \
+} while (/*CONSTCOND*/ 0)
+#else
+#define	CODECACHE_CHECK(addr, size)
+#define	codecache_flush()
+#endif
+
+/* self-modifying code: drop the window when a store hits its span */
+#define	CODEFETCH_WINDOW_CHECK(addr, size) \
+do { \
+	if ((UINT32)((addr) + ((size) - 1) - codefetch_window.paddr) \
+	    < codefetch_window.len + ((size) - 1)) { \
+		codefetch_window.len = 0; \
+	} \
+	CODECACHE_CHECK(addr, size); \
+} while (/*CONSTCOND*/ 0)
+
+#if defined(USE_CODE_CACHE)
+/* the window reads flat memory itself, it sees every store */
+#define	MEMF_CODEFETCH_CHECK(addr, size)
+#else
+#define	MEMF_CODEFETCH_CHECK(addr, size)	CODEFETCH_WINDOW_CHECK(addr, size)
+#endif
+
+STATIC_INLINE REG8 memf_read8(UINT32 address) {
+
+	if (cpumemflat) {
+		return *MEMF_PTR(UINT8, address & CPU_ADRSMASK);
+	}
+	return memp_read8(address);
+}
+
+STATIC_INLINE REG16 memf_read16(UINT32 address) {
+
+	if (cpumemflat) {
+		return *MEMF_PTR(UINT16, address & CPU_ADRSMASK);
+	}
+	return memp_read16(address);
+}
+
+STATIC_INLINE UINT32 memf_read32(UINT32 address) {
+
+	if (cpumemflat) {
+		return *MEMF_PTR(UINT32, address & CPU_ADRSMASK);
+	}
+	return memp_read32(address);
+}
+
+STATIC_INLINE void memf_write8(UINT32 address, REG8 value) {
+
+	if (cpumemflat) {
+		address &= CPU_ADRSMASK;
+		MEMF_CODEFETCH_CHECK(address, 1);
+		*MEMF_PTR(UINT8, address) = value;
+		return;
+	}
+	memp_write8(address, value);
+}
+
+STATIC_INLINE void memf_write16(UINT32 address, REG16 value) {
+
+	if (cpumemflat) {
+		address &= CPU_ADRSMASK;
+		MEMF_CODEFETCH_CHECK(address, 2);
+		*MEMF_PTR(UINT16, address) = value;
+		return;
+	}
+	memp_write16(address, value);
+}
+
+STATIC_INLINE void memf_write32(UINT32 address, UINT32 value) {
+
+	if (cpumemflat) {
+		address &= CPU_ADRSMASK;
+		MEMF_CODEFETCH_CHECK(address, 4);
+		*MEMF_PTR(UINT32, address) = value;
+		return;
+	}
+	memp_write32(address, value);
+}
+
+STATIC_INLINE REG8 memf_read8_codefetch(UINT32 address) {
+
+	if (cpumemflat) {
+		codefetch_address = address & CPU_ADRSMASK;
+		return *MEMF_PTR(UINT8, codefetch_address);
+	}
+	return memp_read8_codefetch(address);
+}
+
+STATIC_INLINE REG16 memf_read16_codefetch(UINT32 address) {
+
+	if (cpumemflat) {
+		return *MEMF_PTR(UINT16, address & CPU_ADRSMASK);
+	}
+	return memp_read16_codefetch(address);
+}
+
+STATIC_INLINE UINT32 memf_read32_codefetch(UINT32 address) {
+
+	if (cpumemflat) {
+		return *MEMF_PTR(UINT32, address & CPU_ADRSMASK);
+	}
+	return memp_read32_codefetch(address);
+}
+
+
 // ---- Physical Space (DMA)
 
 #define	MEMP_READ8(addr)					\
@@ -82,9 +82,223 @@ int cpu_debug_rep_cont = 0;
 CPU_REGS cpu_debug_rep_regs;
 #endif
 
-void
-exec_1step(void)
+UINT8 cpu_inst_prefixed = 1;	/* cpu_inst may hold prefix state */
+
+#if defined(USE_EXCEPTION_LONGJMP)
+jmp_buf *exec_recover;
+#endif
+
+#if defined(USE_HOST_FAULT_RECOVERY)
+/*
+ * In flat memory mode guest memory is accessed by raw host load/store.
+ * An access violation on a guest address (below 4GB) taken by the code
+ * of this module is raised as a guest exception at CPU_PREV_EIP instead
+ * of taking the host thread down.  Faults in host callbacks are left to
+ * the host.  The filter only records the fault; host_fault() raises the
+ * guest exception once the __except block has been left.
+ */
+extern "C" IMAGE_DOS_HEADER __ImageBase;
+
+typedef struct {
+	UINT32	addr;
+	int	write;
+} HOST_FAULT;
+
+static int
+host_fault_filter(const EXCEPTION_RECORD *er, HOST_FAULT *hf)
+{
+	const IMAGE_NT_HEADERS *nt;
+	ULONG_PTR addr;
+	ULONG_PTR pc;
+
+	if ((er->ExceptionCode != EXCEPTION_ACCESS_VIOLATION)
+	 || (er->NumberParameters < 2)
+	 || !cpumemflat) {
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+	addr = er->ExceptionInformation[1];
+	if ((UINT64)addr > 0xffffffff) {
+		/* not a guest address */
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+	nt = (const IMAGE_NT_HEADERS *)((const UINT8 *)&__ImageBase + __ImageBase.e_lfanew);
+	pc = (ULONG_PTR)er->ExceptionAddress - (ULONG_PTR)&__ImageBase;
+	if (pc >= nt->OptionalHeader.SizeOfImage) {
+		/* host callback */
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+	hf->addr = (UINT32)addr;
+	hf->write = (er->ExceptionInformation[0] == 1);
+	return EXCEPTION_EXECUTE_HANDLER;
+}
+
+static void
+host_fault(const HOST_FAULT *hf)
+{
+	UINT err;
+
+	if (CPU_STAT_PAGING) {
+		/* physical address without host memory */
+		EXCEPTION(GP_EXCEPTION, 0);
+	}
+	CPU_CR2 = hf->addr;
+	err = hf->write ? (CPU_PAGE_WRITE << 1) : 0;
+	err |= (CPU_STAT_USER_MODE & CPU_PAGE_USER_MODE) >> 1;
+	EXCEPTION(PF_EXCEPTION, err);
+}
+#endif
+
+#if defined(USE_LAZY_FLAGS)
+LAZYFLAGS lazyflags;
+
+/*
+ * compute CPU_FLAGL/CPU_OV for the recorded operation with the same
+ * macros the eager path uses.  The record is dropped first, so the
+ * CPU_FLAGL/CPU_OV accesses inside the macros don't come back here.
+ */
+void CPUCALL
+lazyflags_sync(void)
+{
+	UINT32 op = lazyflags.op;
+	UINT32 dst = lazyflags.dst;
+	UINT32 src = lazyflags.src;
+	UINT32 res;
+
+	lazyflags.op = LAZYFLAGS_NONE;
+	switch (op) {
+	case LAZYFLAGS_ADD_BYTE:
+		_ADD_BYTE(res, dst, src);
+		break;
+
+	case LAZYFLAGS_ADD_WORD:
+		_ADD_WORD(res, dst, src);
+		break;
+
+	case LAZYFLAGS_ADD_DWORD:
+		_ADD_DWORD(res, dst, src);
+		break;
+
+	case LAZYFLAGS_SUB_BYTE:
+		_BYTE_SUB(res, dst, src);
+		break;
+
+	case LAZYFLAGS_SUB_WORD:
+		_WORD_SUB(res, dst, src);
+		break;
+
+	case LAZYFLAGS_SUB_DWORD:
+		_DWORD_SUB(res, dst, src);
+		break;
+
+	case LAZYFLAGS_LOG_BYTE:
+		_OR_BYTE(dst, src);
+		break;
+
+	case LAZYFLAGS_LOG_WORD:
+		_OR_WORD(dst, src);
+		break;
+
+	case LAZYFLAGS_LOG_DWORD:
+		_OR_DWORD(dst, src);
+		break;
+
+	default:
+		break;
+	}
+	(void)res;
+}
+#endif
+
+/*
+ * prefix bytes are decoded here instead of being called through
+ * insttable_1byte[0][]
+ */
+STATIC_INLINE void
+exec_prefix(UINT32 op)
+{
+
+	CPU_INST_PREFIXED();
+	switch (op) {
+	case 0x26:	/* ES: */
+		CPU_INST_SEGUSE = 1;
+		CPU_INST_SEGREG_INDEX = CPU_ES_INDEX;
+		break;
+
+	case 0x2e:	/* CS: */
+		CPU_INST_SEGUSE = 1;
+		CPU_INST_SEGREG_INDEX = CPU_CS_INDEX;
+		break;
+
+	case 0x36:	/* SS: */
+		CPU_INST_SEGUSE = 1;
+		CPU_INST_SEGREG_INDEX = CPU_SS_INDEX;
+		break;
+
+	case 0x3e:	/* DS: */
+		CPU_INST_SEGUSE = 1;
+		CPU_INST_SEGREG_INDEX = CPU_DS_INDEX;
+		break;
+
+	case 0x64:	/* FS: */
+		CPU_INST_SEGUSE = 1;
+		CPU_INST_SEGREG_INDEX = CPU_FS_INDEX;
+		break;
+
+	case 0x65:	/* GS: */
+		CPU_INST_SEGUSE = 1;
+		CPU_INST_SEGREG_INDEX = CPU_GS_INDEX;
+		break;
+
+	case 0x66:	/* OpSize: */
+		CPU_INST_OP32 = !CPU_STATSAVE.cpu_inst_default.op_32;
+		break;
+
+	case 0x67:	/* AddrSize: */
+		CPU_INST_AS32 = !CPU_STATSAVE.cpu_inst_default.as_32;
+		break;
+
+	case 0xf0:	/* LOCK */
+		break;
+
+	case 0xf2:	/* REPNE */
+		CPU_INST_REPUSE = 0xf2;
+		break;
+
+	case 0xf3:	/* REPE */
+		CPU_INST_REPUSE = 0xf3;
+		break;
+
+	default:	/* FWAIT */
+		(*insttable_1byte[0][op])();
+		break;
+	}
+}
+
+#if defined(USE_FLAT32_TABLE)
+/*
+ * unprefixed instructions in the flat 32bit state go through
+ * insttable_1byte_flat32[].  The state is computed here again when a
+ * segment load or CPU_CLEARPREFETCH() has marked it stale.
+ */
+STATIC_INLINE BOOL
+exec_flat32(UINT32 op)
+{
+
+	if (cpu_inst_prefixed)
+		return FALSE;
+	if (CPU_STAT_FLAT32 == FLAT32_RECHECK)
+		FLAT32_UPDATE();
+	if (!CPU_STAT_FLAT32)
+		return FALSE;
+	(*insttable_1byte_flat32[op])();
+	return TRUE;
+}
+#endif
+
+STATIC_INLINE void
+exec_1step_body(void)
 {
+	void (*repfunc)(int);
 	int prefix;
 	UINT32 op;
 
@@ -92,7 +306,7 @@ exec_1step(void)
 	CPU_PREV_CS = CPU_CS;
 #endif
 	CPU_PREV_EIP = CPU_EIP;
-	CPU_STATSAVE.cpu_inst = CPU_STATSAVE.cpu_inst_default;
+	CPU_INST_RESET();
 
 #if defined(ENABLE_TRAP)
 	steptrap(CPU_CS, CPU_EIP);
@@ -154,7 +368,7 @@ exec_1step(void)
 
 		/* prefix */
 		if (insttable_info[op] & INST_PREFIX) {
-			(*insttable_1byte[0][op])();
+			exec_prefix(op);
 			continue;
 		}
 		break;
@@ -177,6 +391,11 @@ exec_1step(void)
 	if (!(insttable_info[op] & INST_STRING) || !CPU_INST_REPUSE) {
 #if defined(DEBUG)
 		cpu_debug_rep_cont = 0;
+#endif
+#if defined(USE_FLAT32_TABLE)
+		/* the fused pairs would make one step of two instructions */
+		if (!CPU_TRAP && exec_flat32(op))
+			return;
 #endif
 		(*insttable_1byte[CPU_INST_OP32][op])();
 		return;
@@ -190,6 +409,20 @@ exec_1step(void)
 		cpu_debug_rep_regs = CPU_STATSAVE.cpu_regs;
 	}
 #endif
+	repfunc = insttable_1byte_repfunc[CPU_INST_OP32][op];
+	if (repfunc != NULL) {
+		/* MOVS/CMPS/STOS have their own loops, as in exec_allstep() */
+		if (!CPU_INST_AS32 ? (CPU_CX != 0) : (CPU_ECX != 0)) {
+			if (!(insttable_info[op] & REP_CHECKZF)) {
+				(*repfunc)(0);
+			} else if (CPU_INST_REPUSE != 0xf2) {
+				(*repfunc)(1);
+			} else {
+				(*repfunc)(2);
+			}
+		}
+		return;
+	}
 	if (!CPU_INST_AS32) {
 		if (CPU_CX != 0) {
 			if (!(insttable_info[op] & REP_CHECKZF)) {
@@ -291,13 +524,403 @@ exec_1step(void)
 	}
 }
 
+void
+exec_1step(void)
+{
+
+#if defined(USE_HOST_FAULT_RECOVERY)
+	HOST_FAULT hf;
+	BOOL fault = FALSE;
+
+	__try {
+		exec_1step_body();
+	} __except (host_fault_filter((GetExceptionInformation())->ExceptionRecord, &hf)) {
+		fault = TRUE;
+	}
+	if (fault) {
+		host_fault(&hf);
+	}
+#else
+	exec_1step_body();
+#endif
+	CPU_LAZYFLAGS_SYNC();
+}
+
 #if 1
+/*
+ * rep prefixed string instruction
+ */
+STATIC_INLINE void
+exec_allstep_rep(UINT32 op)
+{
+	void (*func)(void);
+
+	CPU_WORKCLOCK(5);
+#if defined(DEBUG)
+	if (!cpu_debug_rep_cont) {
+		cpu_debug_rep_cont = 1;
+		cpu_debug_rep_regs = CPU_STATSAVE.cpu_regs;
+	}
+#endif
+	func = insttable_1byte[CPU_INST_OP32][op];
+	if (!CPU_INST_AS32) {
+		if (CPU_CX != 0) {
+			if(CPU_CX==1){
+				(*func)();
+				--CPU_CX;
+			}else{
+				if (!(insttable_info[op] & REP_CHECKZF)) {
+					if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
+						(*insttable_1byte_repfunc[CPU_INST_OP32][op])(0);
+					}else{
+						/* rep */
+						for (;;) {
+							(*func)();
+							if (--CPU_CX == 0) {
+		#if defined(DEBUG)
+								cpu_debug_rep_cont = 0;
+		#endif
+								break;
+							}
+							if (CPU_REMCLOCK <= 0) {
+								CPU_EIP = CPU_PREV_EIP;
+								break;
+							}
+						}
+					}
+				} else if (CPU_INST_REPUSE != 0xf2) {
+					if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
+						(*insttable_1byte_repfunc[CPU_INST_OP32][op])(1);
+					}else{
+						/* repe */
+						for (;;) {
+							(*func)();
+							if (--CPU_CX == 0 || CC_NZ) {
+		#if defined(DEBUG)
+								cpu_debug_rep_cont = 0;
+		#endif
+								break;
+							}
+							if (CPU_REMCLOCK <= 0) {
+								CPU_EIP = CPU_PREV_EIP;
+								break;
+							}
+						}
+					}
+				} else {
+					if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
+						(*insttable_1byte_repfunc[CPU_INST_OP32][op])(2);
+					}else{
+						/* repne */
+						for (;;) {
+							(*func)();
+							if (--CPU_CX == 0 || CC_Z) {
+		#if defined(DEBUG)
+								cpu_debug_rep_cont = 0;
+		#endif
+								break;
+							}
+							if (CPU_REMCLOCK <= 0) {
+								CPU_EIP = CPU_PREV_EIP;
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+	} else {
+		if (CPU_ECX != 0) {
+			if(CPU_ECX==1){
+				(*func)();
+				--CPU_ECX;
+			}else{
+				if (!(insttable_info[op] & REP_CHECKZF)) {
+					if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
+						(*insttable_1byte_repfunc[CPU_INST_OP32][op])(0);
+					}else{
+						/* rep */
+						for (;;) {
+							(*func)();
+							if (--CPU_ECX == 0) {
+		#if defined(DEBUG)
+								cpu_debug_rep_cont = 0;
+		#endif
+								break;
+							}
+							if (CPU_REMCLOCK <= 0) {
+								CPU_EIP = CPU_PREV_EIP;
+								break;
+							}
+						}
+					}
+				} else if (CPU_INST_REPUSE != 0xf2) {
+					if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
+						(*insttable_1byte_repfunc[CPU_INST_OP32][op])(1);
+					}else{
+						/* repe */
+						for (;;) {
+							(*func)();
+							if (--CPU_ECX == 0 || CC_NZ) {
+		#if defined(DEBUG)
+								cpu_debug_rep_cont = 0;
+		#endif
+								break;
+							}
+							if (CPU_REMCLOCK <= 0) {
+								CPU_EIP = CPU_PREV_EIP;
+								break;
+							}
+						}
+					}
+				} else {
+					if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
+						(*insttable_1byte_repfunc[CPU_INST_OP32][op])(2);
+					}else{
+						/* repne */
+						for (;;) {
+							(*func)();
+							if (--CPU_ECX == 0 || CC_Z) {
+		#if defined(DEBUG)
+								cpu_debug_rep_cont = 0;
+		#endif
+								break;
+							}
+							if (CPU_REMCLOCK <= 0) {
+								CPU_EIP = CPU_PREV_EIP;
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+#if defined(USE_THREADED_DISPATCH)
+/*
+ * threaded dispatch
+ *
+ * Every label fetches the next opcode byte itself and jumps straight to
+ * the label that handles it, so each site has its own indirect branch
+ * instead of all instructions sharing the one at the top of the loop.
+ * Prefixes are decoded in their own labels.
+ *
+ * GCC/Clang jump through a table of label addresses (computed goto).
+ * MSVC has no computed goto, so each site has a switch on the dispatch
+ * class of the opcode; the compiler may merge those switches again.
+ *
+ * The class of each opcode is looked up in threaded_dispatch[], built
+ * once by exec_threaded_init() since several threads may run here.
+ */
+enum {
+	THREADED_NORMAL = 0,
+	THREADED_STRING,
+	THREADED_ES,
+	THREADED_CS,
+	THREADED_SS,
+	THREADED_DS,
+	THREADED_FS,
+	THREADED_GS,
+	THREADED_OPSIZE,
+	THREADED_ADDRSIZE,
+	THREADED_LOCK,
+	THREADED_REPNE,
+	THREADED_REPE,
+	THREADED_OTHER
+};
+
+static int
+threaded_class(UINT32 op)
+{
+
+	if (!(insttable_info[op] & INST_PREFIX))
+		return (insttable_info[op] & INST_STRING) ? THREADED_STRING : THREADED_NORMAL;
+	switch (op) {
+	case 0x26: return THREADED_ES;
+	case 0x2e: return THREADED_CS;
+	case 0x36: return THREADED_SS;
+	case 0x3e: return THREADED_DS;
+	case 0x64: return THREADED_FS;
+	case 0x65: return THREADED_GS;
+	case 0x66: return THREADED_OPSIZE;
+	case 0x67: return THREADED_ADDRSIZE;
+	case 0xf0: return THREADED_LOCK;
+	case 0xf2: return THREADED_REPNE;
+	case 0xf3: return THREADED_REPE;
+	default: return THREADED_OTHER;	/* FWAIT */
+	}
+}
+
+static UINT8 threaded_dispatch[256];
+
 void
-exec_allstep(void)
+exec_threaded_init(void)
+{
+	int op;
+
+	for (op = 0; op < 256; op++) {
+		threaded_dispatch[op] = (UINT8)threaded_class(op);
+	}
+}
+
+#if defined(__GNUC__)
+#define	THREADED_GOTO() \
+	goto *label[threaded_dispatch[op]]
+#else
+#define	THREADED_GOTO() \
+do { \
+	switch (threaded_dispatch[op]) { \
+	case THREADED_NORMAL: goto op_normal; \
+	case THREADED_STRING: goto op_string; \
+	case THREADED_ES: goto prefix_es; \
+	case THREADED_CS: goto prefix_cs; \
+	case THREADED_SS: goto prefix_ss; \
+	case THREADED_DS: goto prefix_ds; \
+	case THREADED_FS: goto prefix_fs; \
+	case THREADED_GS: goto prefix_gs; \
+	case THREADED_OPSIZE: goto prefix_opsize; \
+	case THREADED_ADDRSIZE: goto prefix_addrsize; \
+	case THREADED_LOCK: goto prefix_lock; \
+	case THREADED_REPNE: goto prefix_repne; \
+	case THREADED_REPE: goto prefix_repe; \
+	default: goto prefix_other; \
+	} \
+} while (/*CONSTCOND*/ 0)
+#endif
+
+#define	THREADED_FETCH() \
+do { \
+	CPU_PREV_EIP = CPU_EIP; \
+	CPU_INST_RESET(); \
+	prefix = 0; \
+	GET_PCBYTE(op); \
+	THREADED_GOTO(); \
+} while (/*CONSTCOND*/ 0)
+
+#define	THREADED_NEXT() \
+do { \
+	if (CPU_REMCLOCK <= 0) \
+		return; \
+	THREADED_FETCH(); \
+} while (/*CONSTCOND*/ 0)
+
+#define	THREADED_PREFIX() \
+do { \
+	CPU_INST_PREFIXED(); \
+	if (++prefix == MAX_PREFIX) { \
+		EXCEPTION(UD_EXCEPTION, 0); \
+	} \
+	GET_PCBYTE(op); \
+	THREADED_GOTO(); \
+} while (/*CONSTCOND*/ 0)
+
+static void
+exec_allstep_threaded(void)
 {
+#if defined(__GNUC__)
+	static const void * const label[] = {
+		&&op_normal, &&op_string,
+		&&prefix_es, &&prefix_cs, &&prefix_ss, &&prefix_ds,
+		&&prefix_fs, &&prefix_gs, &&prefix_opsize, &&prefix_addrsize,
+		&&prefix_lock, &&prefix_repne, &&prefix_repe, &&prefix_other
+	};
+#endif
 	int prefix;
 	UINT32 op;
-	void (*func)(void);
+
+	THREADED_FETCH();
+
+prefix_es:
+	CPU_INST_SEGUSE = 1;
+	CPU_INST_SEGREG_INDEX = CPU_ES_INDEX;
+	THREADED_PREFIX();
+
+prefix_cs:
+	CPU_INST_SEGUSE = 1;
+	CPU_INST_SEGREG_INDEX = CPU_CS_INDEX;
+	THREADED_PREFIX();
+
+prefix_ss:
+	CPU_INST_SEGUSE = 1;
+	CPU_INST_SEGREG_INDEX = CPU_SS_INDEX;
+	THREADED_PREFIX();
+
+prefix_ds:
+	CPU_INST_SEGUSE = 1;
+	CPU_INST_SEGREG_INDEX = CPU_DS_INDEX;
+	THREADED_PREFIX();
+
+prefix_fs:
+	CPU_INST_SEGUSE = 1;
+	CPU_INST_SEGREG_INDEX = CPU_FS_INDEX;
+	THREADED_PREFIX();
+
+prefix_gs:
+	CPU_INST_SEGUSE = 1;
+	CPU_INST_SEGREG_INDEX = CPU_GS_INDEX;
+	THREADED_PREFIX();
+
+prefix_opsize:
+	CPU_INST_OP32 = !CPU_STATSAVE.cpu_inst_default.op_32;
+	THREADED_PREFIX();
+
+prefix_addrsize:
+	CPU_INST_AS32 = !CPU_STATSAVE.cpu_inst_default.as_32;
+	THREADED_PREFIX();
+
+prefix_lock:
+	THREADED_PREFIX();
+
+prefix_repne:
+	CPU_INST_REPUSE = 0xf2;
+	THREADED_PREFIX();
+
+prefix_repe:
+	CPU_INST_REPUSE = 0xf3;
+	THREADED_PREFIX();
+
+prefix_other:	/* FWAIT */
+	(*insttable_1byte[0][op])();
+	THREADED_PREFIX();
+
+op_normal:
+#if defined(DEBUG)
+	cpu_debug_rep_cont = 0;
+#endif
+#if defined(USE_FLAT32_TABLE)
+	if (exec_flat32(op))
+		THREADED_NEXT();
+#endif
+	(*insttable_1byte[CPU_INST_OP32][op])();
+	THREADED_NEXT();
+
+op_string:
+	if (!CPU_INST_REPUSE) {
+#if defined(DEBUG)
+		cpu_debug_rep_cont = 0;
+#endif
+		(*insttable_1byte[CPU_INST_OP32][op])();
+		THREADED_NEXT();
+	}
+	exec_allstep_rep(op);
+	THREADED_NEXT();
+}
+
+#undef	THREADED_GOTO
+#undef	THREADED_FETCH
+#undef	THREADED_NEXT
+#undef	THREADED_PREFIX
+#endif	/* USE_THREADED_DISPATCH */
+
+STATIC_INLINE void
+exec_allstep_body(void)
+{
+#if !defined(USE_THREADED_DISPATCH)
+	int prefix;
+	UINT32 op;
+#endif
 #if defined(SUPPORT_ASYNC_CPU)
 	int remclkcnt = INT_MAX;
 	static int latecount = 0;
@@ -313,11 +936,18 @@ exec_allstep(void)
 	}
 	latecount2 = (latecount2+1) & 0x1fff;
 #endif
+
+	/* the host may have changed guest memory and state since the last call */
+	CPU_INST_PREFIXED();
+	CPU_CLEARPREFETCH();
 	
+#if defined(USE_THREADED_DISPATCH)
+	exec_allstep_threaded();
+#else
 	do {
 
 		CPU_PREV_EIP = CPU_EIP;
-		CPU_STATSAVE.cpu_inst = CPU_STATSAVE.cpu_inst_default;
+		CPU_INST_RESET();
 
 	#if defined(ENABLE_TRAP)
 		steptrap(CPU_CS, CPU_EIP);
@@ -373,7 +1003,7 @@ exec_allstep(void)
 
 			/* prefix */
 			if (insttable_info[op] & INST_PREFIX) {
-				(*insttable_1byte[0][op])();
+				exec_prefix(op);
 				continue;
 			}
 			break;
@@ -396,156 +1026,20 @@ exec_allstep(void)
 		if (!(insttable_info[op] & INST_STRING) || !CPU_INST_REPUSE) {
 	#if defined(DEBUG)
 			cpu_debug_rep_cont = 0;
+	#endif
+	#if defined(USE_FLAT32_TABLE)
+			if (exec_flat32(op))
+				continue;
 	#endif
 			(*insttable_1byte[CPU_INST_OP32][op])();
-			goto cpucontinue; //continue;
+			continue;
 		}
 
 		/* rep */
-		CPU_WORKCLOCK(5);
-	#if defined(DEBUG)
-		if (!cpu_debug_rep_cont) {
-			cpu_debug_rep_cont = 1;
-			cpu_debug_rep_regs = CPU_STATSAVE.cpu_regs;
-		}
-	#endif
-		func = insttable_1byte[CPU_INST_OP32][op];
-		if (!CPU_INST_AS32) {
-			if (CPU_CX != 0) {
-				if(CPU_CX==1){
-					(*func)();
-					--CPU_CX;
-				}else{
-					if (!(insttable_info[op] & REP_CHECKZF)) {
-						if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
-							(*insttable_1byte_repfunc[CPU_INST_OP32][op])(0);
-						}else{
-							/* rep */
-							for (;;) {
-								(*func)();
-								if (--CPU_CX == 0) {
-			#if defined(DEBUG)
-									cpu_debug_rep_cont = 0;
-			#endif
-									break;
-								}
-								if (CPU_REMCLOCK <= 0) {
-									CPU_EIP = CPU_PREV_EIP;
-									break;
-								}
-							}
-						}
-					} else if (CPU_INST_REPUSE != 0xf2) {
-						if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
-							(*insttable_1byte_repfunc[CPU_INST_OP32][op])(1);
-						}else{
-							/* repe */
-							for (;;) {
-								(*func)();
-								if (--CPU_CX == 0 || CC_NZ) {
-			#if defined(DEBUG)
-									cpu_debug_rep_cont = 0;
-			#endif
-									break;
-								}
-								if (CPU_REMCLOCK <= 0) {
-									CPU_EIP = CPU_PREV_EIP;
-									break;
-								}
-							}
-						}
-					} else {
-						if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
-							(*insttable_1byte_repfunc[CPU_INST_OP32][op])(2);
-						}else{
-							/* repne */
-							for (;;) {
-								(*func)();
-								if (--CPU_CX == 0 || CC_Z) {
-			#if defined(DEBUG)
-									cpu_debug_rep_cont = 0;
-			#endif
-									break;
-								}
-								if (CPU_REMCLOCK <= 0) {
-									CPU_EIP = CPU_PREV_EIP;
-									break;
-								}
-							}
-						}
-					}
-				}
-			}
-		} else {
-			if (CPU_ECX != 0) {
-				if(CPU_ECX==1){
-					(*func)();
-					--CPU_ECX;
-				}else{
-					if (!(insttable_info[op] & REP_CHECKZF)) {
-						if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
-							(*insttable_1byte_repfunc[CPU_INST_OP32][op])(0);
-						}else{
-							/* rep */
-							for (;;) {
-								(*func)();
-								if (--CPU_ECX == 0) {
-			#if defined(DEBUG)
-									cpu_debug_rep_cont = 0;
-			#endif
-									break;
-								}
-								if (CPU_REMCLOCK <= 0) {
-									CPU_EIP = CPU_PREV_EIP;
-									break;
-								}
-							}
-						}
-					} else if (CPU_INST_REPUSE != 0xf2) {
-						if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
-							(*insttable_1byte_repfunc[CPU_INST_OP32][op])(1);
-						}else{
-							/* repe */
-							for (;;) {
-								(*func)();
-								if (--CPU_ECX == 0 || CC_NZ) {
-			#if defined(DEBUG)
-									cpu_debug_rep_cont = 0;
-			#endif
-									break;
-								}
-								if (CPU_REMCLOCK <= 0) {
-									CPU_EIP = CPU_PREV_EIP;
-									break;
-								}
-							}
-						}
-					} else {
-						if(insttable_1byte_repfunc[CPU_INST_OP32][op]){
-							(*insttable_1byte_repfunc[CPU_INST_OP32][op])(2);
-						}else{
-							/* repne */
-							for (;;) {
-								(*func)();
-								if (--CPU_ECX == 0 || CC_Z) {
-			#if defined(DEBUG)
-									cpu_debug_rep_cont = 0;
-			#endif
-									break;
-								}
-								if (CPU_REMCLOCK <= 0) {
-									CPU_EIP = CPU_PREV_EIP;
-									break;
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-cpucontinue:;
+		exec_allstep_rep(op);
 
 	} while (CPU_REMCLOCK > 0);
+#endif
 
 #if defined(SUPPORT_ASYNC_CPU)
 	//  񓯊 CPU    
@@ -651,4 +1145,64 @@ cpucontinue:;
 	if(hltflag > 0) hltflag--;
 #endif
 }
+
+static void
+exec_allstep_guarded(void)
+{
+
+#if defined(USE_HOST_FAULT_RECOVERY)
+	HOST_FAULT hf;
+	BOOL fault = FALSE;
+
+	__try {
+		exec_allstep_body();
+	} __except (host_fault_filter((GetExceptionInformation())->ExceptionRecord, &hf)) {
+		fault = TRUE;
+	}
+	if (fault) {
+		host_fault(&hf);
+	}
+#else
+	exec_allstep_body();
+#endif
+	CPU_LAZYFLAGS_SYNC();
+}
+
+void
+exec_allstep(void)
+{
+#if defined(USE_EXCEPTION_LONGJMP)
+	jmp_buf jb;
+	jmp_buf *prev = exec_recover;
+
+	/*
+	 * jb stays valid while this frame is live, so every guest exception
+	 * raised below comes back here and the run starts over from the
+	 * handler.  exec_allstep_body() reloads all its state on entry;
+	 * nothing here is changed between setjmp() and longjmp().
+	 */
+	codecache_flush();	/* the host may have changed guest memory */
+	exec_recover = &jb;
+	switch (setjmp(jb)) {
+	case 0:
+		exec_allstep_guarded();
+		break;
+
+	case 1:
+		/* exception delivered, go on with its handler */
+		if (CPU_REMCLOCK > 0) {
+			exec_allstep_guarded();
+		}
+		break;
+
+	default:
+		/* panic */
+		break;
+	}
+	exec_recover = prev;
+#else
+	codecache_flush();	/* the host may have changed guest memory */
+	exec_allstep_guarded();
+#endif
+}
 #endif
\ No newline at end of file
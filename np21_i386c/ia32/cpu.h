@@ -126,6 +126,17 @@
 #define USE_FASTPAGING
 #define USE_VME
 #define IA32_REBOOT_ON_PANIC
+#if defined(_MSC_VER)
+#define USE_HOST_FAULT_RECOVERY	/* host access violation -> guest #PF/#GP */
+#endif
+#define USE_THREADED_DISPATCH	/* exec_allstep() by computed goto, or by switch on MSVC */
+#define USE_LAZY_FLAGS	/* arithmetic flags computed on demand */
+#define USE_FLAT32_TABLE	/* flat 32bit handlers for exec_1step()/exec_allstep() */
+#define USE_MACRO_FUSION	/* flat 32bit CMP/TEST/DEC run the following Jcc */
+#define USE_REP_BULK	/* REP MOVS/STOS by block transfer */
+#define USE_CODE_CACHE	/* fetch window over the whole code page, cached when not flat */
+/* USE_CLOCKLESS comes from the WOW64 DLL project: no clock count, CPU_REMCLOCK <= 0 requests a stop */
+#define USE_EXCEPTION_LONGJMP	/* guest exceptions longjmp back to the run loop */
 
 enum {
 	FPU_TYPE_SOFTFLOAT	= 0, /* Berkeley SoftFloat */
@@ -281,6 +292,8 @@ typedef struct {
 	UINT8		bp_ev;		/* break point event */
 
 	UINT8		backout_sp;	/* backout ESP, when exception */
+	UINT8		ss_flat32;	/* flat SS and 32bit stack */
+	UINT8		flat32;		/* flat 32bit CS/DS/ES/SS, no paging */
 
 	UINT32		pde_base;
 
@@ -534,6 +547,11 @@ extern I386MSR		i386msr;
 #ifndef __cplusplus
 extern sigjmp_buf	exec_1step_jmpbuf;
 #endif
+#if defined(USE_EXCEPTION_LONGJMP)
+#include <setjmp.h>
+/* recovery point of the running exec_allstep()/CPU_EXECUTE_INJIT(), or NULL */
+extern jmp_buf		*exec_recover;
+#endif
 
 //#define CPU_REALCLOCK	49920000
 #define CPU_REALCLOCK	50000000
@@ -1079,13 +1097,76 @@ extern sigjmp_buf	exec_1step_jmpbuf;
 #define FS_BASE		CPU_STAT_SREGBASE(CPU_FS_INDEX)
 #define GS_BASE		CPU_STAT_SREGBASE(CPU_GS_INDEX)
 
+#if defined(USE_MACRO_FUSION) && !defined(USE_FLAT32_TABLE)
+#undef	USE_MACRO_FUSION	/* the fused pairs live in the flat 32bit handlers */
+#endif
+
+#if defined(USE_THREADED_DISPATCH) \
+ && (defined(ENABLE_TRAP) || defined(IA32_INSTRUCTION_TRACE))
+#undef	USE_THREADED_DISPATCH	/* per instruction hooks need the plain loop */
+#endif
+
+#if defined(USE_LAZY_FLAGS) && defined(IA32_CROSS_CHECK)
+#undef	USE_LAZY_FLAGS	/* cross check compares the flags right away */
+#endif
+
+#if defined(USE_LAZY_FLAGS)
+/*
+ * lazy flags
+ *
+ * ADD/SUB/CMP and the logical ops only record their operands here;
+ * CPU_FLAGL and CPU_OV are computed from them the next time any of the
+ * flag registers below is touched.  Nothing is pending outside
+ * exec_1step()/exec_allstep() or while an I/O port handler runs.
+ */
+enum {
+	LAZYFLAGS_NONE = 0,
+	LAZYFLAGS_ADD_BYTE,
+	LAZYFLAGS_ADD_WORD,
+	LAZYFLAGS_ADD_DWORD,
+	LAZYFLAGS_SUB_BYTE,
+	LAZYFLAGS_SUB_WORD,
+	LAZYFLAGS_SUB_DWORD,
+	LAZYFLAGS_LOG_BYTE,
+	LAZYFLAGS_LOG_WORD,
+	LAZYFLAGS_LOG_DWORD
+};
+
+typedef struct {
+	UINT32	op;	/* LAZYFLAGS_* */
+	UINT32	dst;	/* destination operand, or result of LOG */
+	UINT32	src;	/* source operand */
+} LAZYFLAGS;
+
+extern LAZYFLAGS lazyflags;
+void CPUCALL lazyflags_sync(void);
+
+#define	CPU_LAZYFLAGS_SYNC() \
+	((lazyflags.op != LAZYFLAGS_NONE) ? lazyflags_sync() : (void)0)
+#define	CPU_LAZYFLAGS_SET(o, d, s) \
+do { \
+	lazyflags.op = (o); \
+	lazyflags.dst = (d); \
+	lazyflags.src = (s); \
+} while (/*CONSTCOND*/ 0)
+#define	CPU_LAZYFLAGS_CLEAR()	(lazyflags.op = LAZYFLAGS_NONE)
+
+#define CPU_EFLAG	(CPU_LAZYFLAGS_SYNC(), CPU_STATSAVE.cpu_regs.eflags.d)
+#define CPU_FLAG	(CPU_LAZYFLAGS_SYNC(), CPU_STATSAVE.cpu_regs.eflags.w.w)
+#define CPU_FLAGL	(CPU_LAZYFLAGS_SYNC(), CPU_STATSAVE.cpu_regs.eflags.b.l)
+#define CPU_OV		(CPU_LAZYFLAGS_SYNC(), CPU_STATSAVE.cpu_stat.ovflag)
+#else
+#define	CPU_LAZYFLAGS_SYNC()	(void)0
+#define	CPU_LAZYFLAGS_CLEAR()	(void)0
+
 #define CPU_EFLAG	CPU_STATSAVE.cpu_regs.eflags.d
 #define CPU_FLAG	CPU_STATSAVE.cpu_regs.eflags.w.w
 #define CPU_FLAGL	CPU_STATSAVE.cpu_regs.eflags.b.l
+#define CPU_OV		CPU_STATSAVE.cpu_stat.ovflag
+#endif
 #define CPU_FLAGH	CPU_STATSAVE.cpu_regs.eflags.b.h
 #define CPU_TRAP	CPU_STATSAVE.cpu_stat.trap
 #define CPU_INPORT	CPU_STATSAVE.cpu_stat.inport
-#define CPU_OV		CPU_STATSAVE.cpu_stat.ovflag
 
 #define C_FLAG		(1 << 0)
 #define P_FLAG		(1 << 2)
@@ -1126,11 +1207,29 @@ void CPUCALL set_eflags(UINT32 new_flags, UINT32 mask);
 #define	DS_FIX	(!CPU_INST_SEGUSE ? CPU_DS_INDEX : CPU_INST_SEGREG_INDEX)
 #define	SS_FIX	(!CPU_INST_SEGUSE ? CPU_SS_INDEX : CPU_INST_SEGREG_INDEX)
 
+/*
+ * cpu_inst only differs from cpu_inst_default after a prefix byte (the
+ * ModR/M decoders set seg_base themselves), so it is put back at the
+ * start of an instruction only when the previous one had a prefix.
+ */
+extern UINT8 cpu_inst_prefixed;
+#define	CPU_INST_PREFIXED()	(cpu_inst_prefixed = 1)
+#define	CPU_INST_RESET() \
+do { \
+	if (cpu_inst_prefixed) { \
+		cpu_inst_prefixed = 0; \
+		CPU_STATSAVE.cpu_inst = CPU_STATSAVE.cpu_inst_default; \
+	} \
+} while (/*CONSTCOND*/ 0)
+
 #define	CPU_STAT_CS_BASE	CPU_STAT_SREGBASE(CPU_CS_INDEX)
 #define	CPU_STAT_CS_LIMIT	CPU_STAT_SREGLIMIT(CPU_CS_INDEX)
 
 #define	CPU_STAT_ADRSMASK	CPU_STATSAVE.cpu_stat.adrsmask
 #define	CPU_STAT_SS32		CPU_STATSAVE.cpu_stat.ss_32
+#define	CPU_STAT_SS_FLAT32	CPU_STATSAVE.cpu_stat.ss_flat32
+#define	CPU_STAT_FLAT32		CPU_STATSAVE.cpu_stat.flat32
+#define	FLAT32_RECHECK		2	/* CPU_STAT_FLAT32: state may have changed */
 #define	CPU_STAT_RESETREQ	CPU_STATSAVE.cpu_stat.resetreq
 #define	CPU_STAT_PM		CPU_STATSAVE.cpu_stat.protected_mode
 #define	CPU_STAT_PAGING		CPU_STATSAVE.cpu_stat.paging
@@ -1305,6 +1404,9 @@ void CPUCALL ia32_interrupt(int vect, int soft);
 
 void exec_1step(void);
 void exec_allstep(void);
+#if defined(USE_THREADED_DISPATCH)
+void exec_threaded_init(void);
+#endif
 #define	INST_PREFIX	(1 << 0)
 #define	INST_STRING	(1 << 1)
 #define	REP_CHECKZF	(1 << 7)
@@ -368,11 +368,172 @@ exc:
 }
 
 
+#if defined(USE_CODE_CACHE)
+/*
+ * code page cache
+ *
+ * Direct mapped by linear page.  A page is copied on its second window
+ * miss, so code run only once is never copied.  A store to a copied
+ * page drops it back to a candidate; after CODECACHE_STORE_LIMIT such
+ * drops the page is left to the plain window (data shares the page).
+ * codecache_gen++ drops everything: run entry, CR3 and paging changes.
+ */
+#define	CODECACHE_PAGES		64
+#define	CODECACHE_STORE_LIMIT	4
+
+enum {
+	CODECACHE_CANDIDATE = 0,
+	CODECACHE_FILLED,
+	CODECACHE_NOCACHE
+};
+
+typedef struct {
+	UINT32	gen;
+	UINT32	laddr;	/* linear page */
+	UINT32	paddr;	/* physical page */
+	UINT	state;
+	UINT	stores;
+	UINT8	code[CPU_PAGE_SIZE];
+} CODECACHE_PAGE;
+
+UINT8 codecache_map[0x100000 / 8];
+static CODECACHE_PAGE codecache[CODECACHE_PAGES];
+static UINT32 codecache_gen = 1;
+
+void
+codecache_flush(void)
+{
+
+	/* stale codecache_map[] bits clear themselves on the next store */
+	codecache_gen++;
+}
+
+void MEMCALL
+codecache_store(UINT32 addr, UINT size)
+{
+	CODECACHE_PAGE *cp;
+	UINT32 page;
+	UINT pages;
+	int i;
+
+	if (size == 0)
+		return;
+
+	page = addr >> 12;
+	pages = (((addr & CPU_PAGE_MASK) + (size - 1)) >> 12) + 1;
+	for (; pages > 0; pages--, page = (page + 1) & 0xfffff) {
+		if (!(codecache_map[page >> 3] & (1 << (page & 7))))
+			continue;
+		codecache_map[page >> 3] &= ~(1 << (page & 7));
+
+		/* a physical page may be held under more than one linear page */
+		for (i = 0, cp = codecache; i < CODECACHE_PAGES; i++, cp++) {
+			if ((cp->gen == codecache_gen)
+			 && (cp->state == CODECACHE_FILLED)
+			 && ((cp->paddr >> 12) == page)) {
+				if (++cp->stores < CODECACHE_STORE_LIMIT) {
+					cp->state = CODECACHE_CANDIDATE;
+				} else {
+					cp->state = CODECACHE_NOCACHE;
+				}
+			}
+		}
+	}
+}
+
+/* held copy of the code page at laddr/paddr, or NULL */
+static const UINT8 *
+codecache_lookup(UINT32 laddr, UINT32 paddr)
+{
+	CODECACHE_PAGE *cp;
+	UINT32 page;
+
+	laddr &= ~CPU_PAGE_MASK;
+	paddr &= ~CPU_PAGE_MASK;
+	cp = &codecache[(laddr >> 12) & (CODECACHE_PAGES - 1)];
+	if ((cp->gen != codecache_gen)
+	 || (cp->laddr != laddr) || (cp->paddr != paddr)) {
+		cp->gen = codecache_gen;
+		cp->laddr = laddr;
+		cp->paddr = paddr;
+		cp->state = CODECACHE_CANDIDATE;
+		cp->stores = 0;
+		return NULL;
+	}
+
+	switch (cp->state) {
+	case CODECACHE_FILLED:
+		return cp->code;
+
+	case CODECACHE_CANDIDATE:
+		memp_reads(paddr, cp->code, CPU_PAGE_SIZE);
+		page = paddr >> 12;
+		codecache_map[page >> 3] |= (1 << (page & 7));
+		cp->state = CODECACHE_FILLED;
+		return cp->code;
+	}
+	return NULL;
+}
+#endif
+
 /*
  * code fetch
  */
-UINT8 MEMCALL
-cpu_codefetch(UINT32 offset)
+static void MEMCALL
+cpu_codefetch_window_load(UINT32 offset)
+{
+	const int ucrw = CPU_PAGE_READ_CODE | CPU_STAT_USER_MODE;
+	descriptor_t *sdp;
+	UINT32 addr;
+	UINT32 paddr;
+	UINT len;
+#if defined(USE_CODE_CACHE)
+	const UINT8 *code;
+#endif
+
+	codefetch_window.len = 0;
+
+	sdp = &CPU_CS_DESC;
+	addr = sdp->u.seg.segbase + offset;
+
+	len = CPU_PAGE_SIZE - (addr & CPU_PAGE_MASK);
+	if (CPU_STAT_PM) {
+		if (offset > sdp->u.seg.limit)
+			return;
+		if (sdp->u.seg.limit - offset < len - 1)
+			len = sdp->u.seg.limit - offset + 1;
+	}
+
+	paddr = laddr_to_paddr(addr, ucrw) & CPU_ADRSMASK;
+
+#if defined(USE_CODE_CACHE)
+	/* flat memory is read in place: stores reach the window by themselves */
+	if (cpumemflat) {
+		codefetch_window.ptr = MEMF_PTR(UINT8, paddr);
+		goto done;
+	}
+	code = codecache_lookup(addr, paddr);
+	if (code != NULL) {
+		codefetch_window.ptr = code + (addr & CPU_PAGE_MASK);
+		goto done;
+	}
+#endif
+
+	if (len > CODEFETCH_WINDOW_SIZE)
+		len = CODEFETCH_WINDOW_SIZE;
+	memp_reads(paddr, codefetch_window.buf, len);
+	codefetch_window.ptr = codefetch_window.buf;
+
+#if defined(USE_CODE_CACHE)
+done:
+#endif
+	codefetch_window.laddr = addr;
+	codefetch_window.paddr = paddr;
+	codefetch_window.len = len;
+}
+
+static UINT8 MEMCALL
+cpu_codefetch_slow(UINT32 offset)
 {
 	const int ucrw = CPU_PAGE_READ_CODE | CPU_STAT_USER_MODE;
 	descriptor_t *sdp;
@@ -390,8 +551,8 @@ cpu_codefetch(UINT32 offset)
 	return 0;	/* compiler happy */
 }
 
-UINT16 MEMCALL
-cpu_codefetch_w(UINT32 offset)
+static UINT16 MEMCALL
+cpu_codefetch_slow_w(UINT32 offset)
 {
 	const int ucrw = CPU_PAGE_READ_CODE | CPU_STAT_USER_MODE;
 	descriptor_t *sdp;
@@ -409,8 +570,8 @@ cpu_codefetch_w(UINT32 offset)
 	return 0;	/* compiler happy */
 }
 
-UINT32 MEMCALL
-cpu_codefetch_d(UINT32 offset)
+static UINT32 MEMCALL
+cpu_codefetch_slow_d(UINT32 offset)
 {
 	const int ucrw = CPU_PAGE_READ_CODE | CPU_STAT_USER_MODE;
 	descriptor_t *sdp;
@@ -429,6 +590,39 @@ cpu_codefetch_d(UINT32 offset)
 	return 0;	/* compiler happy */
 }
 
+/* window miss: reload at offset, fall back to the old path across page/limit */
+UINT8 MEMCALL
+cpu_codefetch_fill(UINT32 offset)
+{
+
+	cpu_codefetch_window_load(offset);
+	if (codefetch_window.len > 0) {
+		codefetch_address = codefetch_window.paddr;
+		return codefetch_window.ptr[0];
+	}
+	return cpu_codefetch_slow(offset);
+}
+
+UINT16 MEMCALL
+cpu_codefetch_fill_w(UINT32 offset)
+{
+
+	cpu_codefetch_window_load(offset);
+	if (codefetch_window.len >= 2)
+		return *(const UINT16 *)codefetch_window.ptr;
+	return cpu_codefetch_slow_w(offset);
+}
+
+UINT32 MEMCALL
+cpu_codefetch_fill_d(UINT32 offset)
+{
+
+	cpu_codefetch_window_load(offset);
+	if (codefetch_window.len >= 4)
+		return *(const UINT32 *)codefetch_window.ptr;
+	return cpu_codefetch_slow_d(offset);
+}
+
 /*
  * additional physical address memory access functions
  */
@@ -480,6 +674,40 @@ cpu_memorywrite_f(UINT32 paddr, const REG80 *value)
 	cpu_memorywrite_w(paddr + 8, value->d.h);
 }
 
+/* 128bit: one host load/store in flat memory mode */
+XMM_REG MEMCALL
+cpu_memoryread_dq(UINT32 paddr)
+{
+	XMM_REG value;
+
+	if (cpumemflat) {
+		memcpy(&value, MEMF_PTR(UINT8, paddr & CPU_ADRSMASK), sizeof(value));
+		return value;
+	}
+	value.ul32[0] = cpu_memoryread_d(paddr);
+	value.ul32[1] = cpu_memoryread_d(paddr + 4);
+	value.ul32[2] = cpu_memoryread_d(paddr + 8);
+	value.ul32[3] = cpu_memoryread_d(paddr + 12);
+
+	return value;
+}
+
+void MEMCALL
+cpu_memorywrite_dq(UINT32 paddr, const XMM_REG *value)
+{
+
+	if (cpumemflat) {
+		paddr &= CPU_ADRSMASK;
+		MEMF_CODEFETCH_CHECK(paddr, 16);
+		memcpy(MEMF_PTR(UINT8, paddr), value, sizeof(*value));
+		return;
+	}
+	cpu_memorywrite_d(paddr, value->ul32[0]);
+	cpu_memorywrite_d(paddr + 4, value->ul32[1]);
+	cpu_memorywrite_d(paddr + 8, value->ul32[2]);
+	cpu_memorywrite_d(paddr + 12, value->ul32[3]);
+}
+
 /*
  * virtual address memory access functions
  */
@@ -508,6 +736,9 @@ cpu_vmemoryread_f(int idx, UINT32 offset)
 	sdp = &CPU_STAT_SREG(idx);
 	addr = sdp->u.seg.segbase + offset;
 
+	if (SEG_IS_FLAT(sdp))
+		return cpu_lmemoryread_f(addr, CPU_PAGE_READ_DATA | CPU_STAT_USER_MODE);
+
 	if (!CPU_STAT_PM)
 		return cpu_memoryread_f(addr);
 
@@ -547,6 +778,11 @@ cpu_vmemorywrite_f(int idx, UINT32 offset, const REG80 *value)
 	sdp = &CPU_STAT_SREG(idx);
 	addr = sdp->u.seg.segbase + offset;
 
+	if (SEG_IS_FLAT(sdp)) {
+		cpu_lmemorywrite_f(addr, value, CPU_PAGE_WRITE_DATA | CPU_STAT_USER_MODE);
+		return;
+	}
+
 	if (!CPU_STAT_PM) {
 		cpu_memorywrite_f(addr, value);
 		return;
@@ -571,3 +807,222 @@ range_failure:
 err:
 	EXCEPTION(exc, 0);
 }
+
+XMM_REG MEMCALL
+cpu_vmemoryread_dq(int idx, UINT32 offset)
+{
+	descriptor_t *sdp;
+	UINT32 addr;
+	int exc;
+
+	__ASSERT((unsigned int)idx < CPU_SEGREG_NUM);
+
+	sdp = &CPU_STAT_SREG(idx);
+	addr = sdp->u.seg.segbase + offset;
+
+	if (SEG_IS_FLAT(sdp))
+		return cpu_lmemoryread_dq(addr, CPU_PAGE_READ_DATA | CPU_STAT_USER_MODE);
+
+	if (!CPU_STAT_PM)
+		return cpu_memoryread_dq(addr);
+
+	if (!SEG_IS_VALID(sdp)) {
+		exc = GP_EXCEPTION;
+		goto err;
+	}
+	if (!(sdp->flag & CPU_DESC_FLAG_READABLE)) {
+		cpu_memoryread_check(sdp, offset, 16, CHOOSE_EXCEPTION(idx));
+	} else if (!(sdp->flag & CPU_DESC_FLAG_WHOLEADR)) {
+		if (!check_limit_upstairs(sdp, offset, 16, SEG_IS_32BIT(sdp)))
+			goto range_failure;
+	} 
+	return cpu_lmemoryread_dq(addr, CPU_PAGE_READ_DATA | CPU_STAT_USER_MODE);
+
+range_failure:
+	VERBOSE(("cpu_vmemoryread_dq: type = %d, offset = %08x, limit = %08x", sdp->type, offset, sdp->u.seg.limit));
+	exc = CHOOSE_EXCEPTION(idx);
+err:
+	EXCEPTION(exc, 0);
+	{
+		XMM_REG dummy;
+		memset(&dummy, 0, sizeof(dummy));
+		return dummy;	/* compiler happy */
+	}
+}
+
+void MEMCALL
+cpu_vmemorywrite_dq(int idx, UINT32 offset, const XMM_REG *value)
+{
+	descriptor_t *sdp;
+	UINT32 addr;
+	int exc;
+
+	__ASSERT((unsigned int)idx < CPU_SEGREG_NUM);
+
+	sdp = &CPU_STAT_SREG(idx);
+	addr = sdp->u.seg.segbase + offset;
+
+	if (SEG_IS_FLAT(sdp)) {
+		cpu_lmemorywrite_dq(addr, value, CPU_PAGE_WRITE_DATA | CPU_STAT_USER_MODE);
+		return;
+	}
+
+	if (!CPU_STAT_PM) {
+		cpu_memorywrite_dq(addr, value);
+		return;
+	}
+
+	if (!SEG_IS_VALID(sdp)) {
+		exc = GP_EXCEPTION;
+		goto err;
+	}
+	if (!(sdp->flag & CPU_DESC_FLAG_WRITABLE)) {
+		cpu_memorywrite_check(sdp, offset, 16, CHOOSE_EXCEPTION(idx));
+	} else if (!(sdp->flag & CPU_DESC_FLAG_WHOLEADR)) {
+		if (!check_limit_upstairs(sdp, offset, 16, SEG_IS_32BIT(sdp)))
+			goto range_failure;
+	}
+	cpu_lmemorywrite_dq(addr, value, CPU_PAGE_WRITE_DATA | CPU_STAT_USER_MODE);
+	return;
+
+range_failure:
+	VERBOSE(("cpu_vmemorywrite_dq: type = %d, offset = %08x, limit = %08x", sdp->type, offset, sdp->u.seg.limit));
+	exc = CHOOSE_EXCEPTION(idx);
+err:
+	EXCEPTION(exc, 0);
+}
+
+/*
+ * block access (FPU/SSE state image)
+ *
+ * All segment and page checks are done before the first byte moves,
+ * so a fault never leaves a partially written block.
+ */
+static UINT32 MEMCALL
+cpu_vmemory_block_check(int idx, UINT32 offset, UINT length, int ucrw)
+{
+	descriptor_t *sdp;
+	UINT32 addr;
+	UINT32 last;
+	int exc;
+
+	__ASSERT((unsigned int)idx < CPU_SEGREG_NUM);
+	__ASSERT(length > 0);
+
+	sdp = &CPU_STAT_SREG(idx);
+	addr = sdp->u.seg.segbase + offset;
+
+	if (SEG_IS_FLAT(sdp) || !CPU_STAT_PM)
+		goto page_check;
+
+	if (!SEG_IS_VALID(sdp)) {
+		exc = GP_EXCEPTION;
+		goto err;
+	}
+	if (ucrw & CPU_PAGE_WRITE) {
+		if (!(sdp->flag & CPU_DESC_FLAG_WRITABLE)) {
+			cpu_memorywrite_check(sdp, offset, length, CHOOSE_EXCEPTION(idx));
+			goto page_check;
+		}
+	} else {
+		if (!(sdp->flag & CPU_DESC_FLAG_READABLE)) {
+			cpu_memoryread_check(sdp, offset, length, CHOOSE_EXCEPTION(idx));
+			goto page_check;
+		}
+	}
+	if (!(sdp->flag & CPU_DESC_FLAG_WHOLEADR)) {
+		if (!check_limit_upstairs(sdp, offset, length, SEG_IS_32BIT(sdp)))
+			goto range_failure;
+	}
+
+page_check:
+	last = addr + length - 1;
+	if (CPU_STAT_PAGING && ((addr ^ last) & ~CPU_PAGE_MASK)) {
+		/* the first page is translated by the transfer itself */
+		(void)laddr_to_paddr(last, ucrw);
+	}
+	return addr;
+
+range_failure:
+	VERBOSE(("cpu_vmemory_block_check: type = %d, offset = %08x, limit = %08x", sdp->type, offset, sdp->u.seg.limit));
+	exc = CHOOSE_EXCEPTION(idx);
+err:
+	EXCEPTION(exc, 0);
+	return 0;	/* compiler happy */
+}
+
+void MEMCALL
+cpu_vmemoryread_block(int idx, UINT32 offset, void *data, UINT length)
+{
+	UINT32 addr;
+	int ucrw;
+
+	if (length == 0)
+		return;
+
+	ucrw = CPU_PAGE_READ_DATA | CPU_STAT_USER_MODE;
+	addr = cpu_vmemory_block_check(idx, offset, length, ucrw);
+	cpu_memory_access_la_region(addr, length, ucrw, (UINT8 *)data);
+}
+
+void MEMCALL
+cpu_vmemorywrite_block(int idx, UINT32 offset, const void *data, UINT length)
+{
+	UINT32 addr;
+	int ucrw;
+
+	if (length == 0)
+		return;
+
+	ucrw = CPU_PAGE_WRITE_DATA | CPU_STAT_USER_MODE;
+	addr = cpu_vmemory_block_check(idx, offset, length, ucrw);
+	cpu_memory_access_la_region(addr, length, ucrw, (UINT8 *)data);
+}
+
+#if defined(USE_HOST_FAULT_RECOVERY)
+/*
+ * Read one byte of every host page of the span before the callers
+ * memcpy()/memset() it, so that a missing page faults before anything
+ * has been transferred.  A store to a read-only page still faults in
+ * the middle of the copy; the host fault filter recovers that as well.
+ * Nothing is written here, so data stored by other threads is left alone.
+ */
+static void
+cpu_vmemory_hostptr_probe(UINT32 addr, UINT length)
+{
+	UINT32 last = addr + length - 1;
+
+	for (;;) {
+		(void)*(volatile UINT8 *)MEMF_PTR(UINT8, addr);
+		if (((addr ^ last) & ~CPU_PAGE_MASK) == 0)
+			break;
+		addr = (addr | CPU_PAGE_MASK) + 1;
+	}
+}
+#endif
+
+/*
+ * Host pointer to the guest block, or NULL if the block is not one
+ * contiguous span of host memory (paging, bus callbacks, A20 mask, 4GB
+ * wrap).  ucrw is CPU_PAGE_READ_DATA or CPU_PAGE_WRITE_DATA.
+ */
+UINT8 * MEMCALL
+cpu_vmemory_hostptr(int idx, UINT32 offset, UINT length, int ucrw)
+{
+	UINT32 addr;
+
+	if (!cpumemflat || CPU_STAT_PAGING || (CPU_ADRSMASK != ~(UINT32)0) || (length == 0))
+		return NULL;
+
+	ucrw |= CPU_STAT_USER_MODE;
+	addr = cpu_vmemory_block_check(idx, offset, length, ucrw);
+	if ((UINT32)(addr + length - 1) < addr)
+		return NULL;
+	if (ucrw & CPU_PAGE_WRITE) {
+		MEMF_CODEFETCH_CHECK(addr, length);
+	}
+#if defined(USE_HOST_FAULT_RECOVERY)
+	cpu_vmemory_hostptr_probe(addr, length);
+#endif
+	return MEMF_PTR(UINT8, addr);
+}
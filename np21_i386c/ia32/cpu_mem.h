@@ -56,12 +56,17 @@ void MEMCALL cpu_vmemorywrite_w(int idx, UINT32 offset, UINT16 value);
 void MEMCALL cpu_vmemorywrite_d(int idx, UINT32 offset, UINT32 value);
 void MEMCALL cpu_vmemorywrite_q(int idx, UINT32 offset, UINT64 value);
 void MEMCALL cpu_vmemorywrite_f(int idx, UINT32 offset, const REG80 *value);
+void MEMCALL cpu_vmemorywrite_dq(int idx, UINT32 offset, const XMM_REG *value);
 UINT8 MEMCALL cpu_vmemoryread_b(int idx, UINT32 offset);
 #define	cpu_vmemoryread(i,o)		cpu_vmemoryread_b(i,o)
 UINT16 MEMCALL cpu_vmemoryread_w(int idx, UINT32 offset);
 UINT32 MEMCALL cpu_vmemoryread_d(int idx, UINT32 offset);
 UINT64 MEMCALL cpu_vmemoryread_q(int idx, UINT32 offset);
 REG80 MEMCALL cpu_vmemoryread_f(int idx, UINT32 offset);
+XMM_REG MEMCALL cpu_vmemoryread_dq(int idx, UINT32 offset);
+void MEMCALL cpu_vmemoryread_block(int idx, UINT32 offset, void *data, UINT length);
+void MEMCALL cpu_vmemorywrite_block(int idx, UINT32 offset, const void *data, UINT length);
+UINT8 * MEMCALL cpu_vmemory_hostptr(int idx, UINT32 offset, UINT length, int ucrw);
 UINT32 MEMCALL cpu_vmemory_RMW_b(int idx, UINT32 offset, UINT32 (CPUCALL *func)(UINT32, void *), void *arg);
 UINT32 MEMCALL cpu_vmemory_RMW_w(int idx, UINT32 offset, UINT32 (CPUCALL *func)(UINT32, void *), void *arg);
 UINT32 MEMCALL cpu_vmemory_RMW_d(int idx, UINT32 offset, UINT32 (CPUCALL *func)(UINT32, void *), void *arg);
@@ -69,17 +74,69 @@ UINT32 MEMCALL cpu_vmemory_RMW_d(int idx, UINT32 offset, UINT32 (CPUCALL *func)(
 /*
  * code fetch
  */
-UINT8 MEMCALL cpu_codefetch(UINT32 offset);
-UINT16 MEMCALL cpu_codefetch_w(UINT32 offset);
-UINT32 MEMCALL cpu_codefetch_d(UINT32 offset);
+UINT8 MEMCALL cpu_codefetch_fill(UINT32 offset);
+UINT16 MEMCALL cpu_codefetch_fill_w(UINT32 offset);
+UINT32 MEMCALL cpu_codefetch_fill_d(UINT32 offset);
+
+STATIC_INLINE UINT8 MEMCALL
+cpu_codefetch(UINT32 offset)
+{
+	UINT32 pos;
+
+	pos = CPU_CS_DESC.u.seg.segbase + offset - codefetch_window.laddr;
+	if (pos < codefetch_window.len) {
+		codefetch_address = codefetch_window.paddr + pos;
+		return codefetch_window.ptr[pos];
+	}
+	return cpu_codefetch_fill(offset);
+}
+
+STATIC_INLINE UINT16 MEMCALL
+cpu_codefetch_w(UINT32 offset)
+{
+	UINT32 pos;
+
+	pos = CPU_CS_DESC.u.seg.segbase + offset - codefetch_window.laddr;
+	if (pos < codefetch_window.len && codefetch_window.len - pos >= 2)
+		return *(const UINT16 *)(codefetch_window.ptr + pos);
+	return cpu_codefetch_fill_w(offset);
+}
+
+STATIC_INLINE UINT32 MEMCALL
+cpu_codefetch_d(UINT32 offset)
+{
+	UINT32 pos;
+
+	pos = CPU_CS_DESC.u.seg.segbase + offset - codefetch_window.laddr;
+	if (pos < codefetch_window.len && codefetch_window.len - pos >= 4)
+		return *(const UINT32 *)(codefetch_window.ptr + pos);
+	return cpu_codefetch_fill_d(offset);
+}
+
+/*
+ * the two code bytes at offset if they are already in the fetch window,
+ * or -1.  The window is not filled, so this can't fault.
+ */
+STATIC_INLINE SINT32 MEMCALL
+cpu_codepeek_w(UINT32 offset)
+{
+	UINT32 pos;
+
+	pos = CPU_CS_DESC.u.seg.segbase + offset - codefetch_window.laddr;
+	if (pos < codefetch_window.len && codefetch_window.len - pos >= 2)
+		return *(const UINT16 *)(codefetch_window.ptr + pos);
+	return -1;
+}
 
 /*
  * additional physical address function
  */
 UINT64 MEMCALL cpu_memoryread_q(UINT32 paddr);
 REG80 MEMCALL cpu_memoryread_f(UINT32 paddr);
+XMM_REG MEMCALL cpu_memoryread_dq(UINT32 paddr);
 void MEMCALL cpu_memorywrite_q(UINT32 paddr, UINT64 value);
 void MEMCALL cpu_memorywrite_f(UINT32 paddr, const REG80 *value);
+void MEMCALL cpu_memorywrite_dq(UINT32 paddr, const XMM_REG *value);
 
 //#ifdef __cplusplus
 //}
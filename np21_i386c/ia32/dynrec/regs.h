@@ -119,6 +119,7 @@ static INLINE RealPt RealMakeSeg(SegNames index,uint16_t off) {
 static INLINE void SegSet16(Bitu index,uint16_t val) {
 	CPU_STATSAVE.cpu_regs.sreg[index]=(Bitu)val;
 	CPU_STATSAVE.cpu_stat.sreg[index].u.seg.segbase=(PhysPt)((unsigned int)val << 4U);
+	CPU_STATSAVE.cpu_stat.sreg[index].flag&=~CPU_DESC_FLAG_FLAT;
 	/* real mode does not update limit */
 }
 
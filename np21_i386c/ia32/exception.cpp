@@ -64,6 +64,8 @@ static const int exctype[EXCEPTION_NUM] = {
 	1, 0, 0, 0, 0, 0, 0, 0, 3, 0, 1, 1, 1, 1, 2, 0, 0, 0, 0, 0,
 };
 
+UINT64 i386excstat[EXCEPTION_NUM];
+
 static const int dftable[4][4] = {
 	{ 0, 0, 0, 1, },
 	{ 0, 1, 0, 1, },
@@ -82,6 +84,8 @@ exception(int num, int error_code)
 
 	__ASSERT((unsigned int)num < EXCEPTION_NUM);
 
+	CPU_LAZYFLAGS_SYNC();	/* may leave exec_*step() by longjmp/throw */
+
 #if 0
 	iptrace_out();
 	debugwriteseg("execption.bin", &CPU_CS_DESC, CPU_PREV_EIP & 0xffff0000, 0x10000);
@@ -164,11 +168,17 @@ exception(int num, int error_code)
 		}
 	}
 	CPU_STAT_PREV_EXCEPTION = num;
+	i386excstat[num]++;
 
 	VERBOSE(("exception: ---------------------------------------------------------------- end"));
 
 	interrupt(num, INTR_TYPE_EXCEPTION, errorp, error_code);
 	CPU_STAT_EXCEPTION_COUNTER_CLEAR();
+#if defined(USE_EXCEPTION_LONGJMP)
+	if (exec_recover != NULL) {
+		longjmp(*exec_recover, 1);
+	}
+#endif
 #ifdef __cplusplus
 	throw(1);
 #else
@@ -68,6 +68,9 @@ enum {
 void CPUCALL exception(int num, int vec);
 void CPUCALL interrupt(int num, int intrtype, int errorp, int error_code);
 
+/* delivered exceptions per vector (CPU_GET_REGPTR(9)) */
+extern UINT64 i386excstat[EXCEPTION_NUM];
+
 //#ifdef __cplusplus
 //}
 //#endif
@@ -149,6 +149,40 @@ Grp1_EdId(void)
 	}
 }
 
+#if defined(USE_MACRO_FUSION)
+/*
+ * CPU_STAT_FLAT32: cmp Ed, Ix runs a following Jcc as well, the other
+ * ops go to the generic handler.
+ */
+#define	GRP1_EDIX_FLAT32(inst, getimm) \
+void \
+inst##_flat32(void) \
+{ \
+	UINT32 op, src, dst; \
+\
+	op = cpu_codefetch(CPU_EIP); \
+	if (((op >> 3) & 7) != 7) { \
+		inst(); \
+		return; \
+	} \
+	CPU_EIP++; \
+	if (op >= 0xc0) { \
+		CPU_WORKCLOCK(2); \
+		dst = *(reg32_b20[op]); \
+		getimm(src); \
+	} else { \
+		CPU_WORKCLOCK(7); \
+		dst = cpu_memoryread_d(calc_ea32_dst(op)); \
+		getimm(src); \
+	} \
+	DWORD_CMP(dst, src); \
+	FUSE_JCC_SUB_DWORD(dst, src); \
+}
+
+GRP1_EDIX_FLAT32(Grp1_EdIb, GET_PCBYTESD)
+GRP1_EDIX_FLAT32(Grp1_EdId, GET_PCDWORD)
+#endif
+
 
 /* group 2 */
 void
@@ -36,6 +36,10 @@ void Grp1_EwIb(void);
 void Grp1_EdIb(void);
 void Grp1_EwIw(void);
 void Grp1_EdId(void);
+#if defined(USE_MACRO_FUSION)
+void Grp1_EdIb_flat32(void);	/* CPU_STAT_FLAT32 */
+void Grp1_EdId_flat32(void);
+#endif
 
 /* group 2 */
 void Grp2_Eb(void);
@@ -83,6 +83,9 @@ ia32_init(void)
 	}
 
 	resolve_init();
+#if defined(USE_THREADED_DISPATCH)
+	exec_threaded_init();
+#endif
 }
 
 #if 0
@@ -202,6 +205,7 @@ change_pm(BOOL onoff)
 	    CPU_STATSAVE.cpu_inst_default.op_32 = 
 	    CPU_STATSAVE.cpu_inst_default.as_32 = 0;
 	CPU_STAT_SS32 = 0;
+	SS_UPDATE_FLAT32();
 	set_cpl(0);
 	CPU_STAT_PM = onoff;
 }
@@ -217,6 +221,8 @@ change_pg(BOOL onoff)
 	}
 
 	CPU_STAT_PAGING = onoff;
+	codecache_flush();
+	CPU_CLEARPREFETCH();
 }
 
 void CPUCALL
@@ -234,10 +240,12 @@ change_vm(BOOL onoff)
 		    CPU_STATSAVE.cpu_inst_default.op_32 =
 		    CPU_STATSAVE.cpu_inst_default.as_32 = 0;
 		CPU_STAT_SS32 = 0;
+		SS_UPDATE_FLAT32();
 		set_cpl(3);
 	} else {
 		VERBOSE(("change_vm: Leaveing from Virtual-8086-Mode..."));
 	}
+	CPU_STAT_FLAT32 = FLAT32_RECHECK;
 }
 
 /*
@@ -297,6 +305,8 @@ set_cr3(UINT32 new_cr3)
 	CPU_CR3 = new_cr3 & CPU_CR3_MASK;
 	CPU_STAT_PDE_BASE = CPU_CR3 & CPU_CR3_PD_MASK;
 	tlb_flush();
+	codecache_flush();
+	CPU_CLEARPREFETCH();
 }
 
 /*
@@ -309,4 +319,5 @@ set_cpl(int new_cpl)
 
 	CPU_STAT_CPL = (UINT8)cpl;
 	CPU_STAT_USER_MODE = (cpl == 3) ? CPU_MODE_USER : CPU_MODE_SUPERVISER;
+	CPU_CLEARPREFETCH();
 }
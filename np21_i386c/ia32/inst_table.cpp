@@ -897,6 +897,90 @@ void (*insttable_1byte[2][256])(void) = {
 	},
 };
 
+#if defined(USE_FLAT32_TABLE)
+/*
+ * unprefixed instructions in the CPU_STAT_FLAT32 state: the 32bit table
+ * with the hot memory and branch forms replaced by versions without
+ * address size, segment, limit and paging checks.
+ */
+void (*insttable_1byte_flat32[256])(void);
+
+static const struct {
+	UINT8	op;
+	void	(*func)(void);
+} insttable_flat32_ops[] = {
+	{ 0x01, ADD_EdGd_flat32 },
+	{ 0x03, ADD_GdEd_flat32 },
+	{ 0x09, OR_EdGd_flat32 },
+	{ 0x0b, OR_GdEd_flat32 },
+	{ 0x21, AND_EdGd_flat32 },
+	{ 0x23, AND_GdEd_flat32 },
+	{ 0x29, SUB_EdGd_flat32 },
+	{ 0x2b, SUB_GdEd_flat32 },
+	{ 0x31, XOR_EdGd_flat32 },
+	{ 0x33, XOR_GdEd_flat32 },
+	{ 0x39, CMP_EdGd_flat32 },
+	{ 0x3b, CMP_GdEd_flat32 },
+	{ 0x70, JO_Jb_flat32 },
+	{ 0x71, JNO_Jb_flat32 },
+	{ 0x72, JC_Jb_flat32 },
+	{ 0x73, JNC_Jb_flat32 },
+	{ 0x74, JZ_Jb_flat32 },
+	{ 0x75, JNZ_Jb_flat32 },
+	{ 0x76, JNA_Jb_flat32 },
+	{ 0x77, JA_Jb_flat32 },
+	{ 0x78, JS_Jb_flat32 },
+	{ 0x79, JNS_Jb_flat32 },
+	{ 0x7a, JP_Jb_flat32 },
+	{ 0x7b, JNP_Jb_flat32 },
+	{ 0x7c, JL_Jb_flat32 },
+	{ 0x7d, JNL_Jb_flat32 },
+	{ 0x7e, JLE_Jb_flat32 },
+	{ 0x7f, JNLE_Jb_flat32 },
+	{ 0x85, TEST_EdGd_flat32 },
+	{ 0x88, MOV_EbGb_flat32 },
+	{ 0x89, MOV_EdGd_flat32 },
+	{ 0x8a, MOV_GbEb_flat32 },
+	{ 0x8b, MOV_GdEd_flat32 },
+	{ 0x8d, LEA_GdM_flat32 },
+	{ 0xa1, MOV_EAXOd_flat32 },
+	{ 0xa3, MOV_OdEAX_flat32 },
+	{ 0xc3, RETnear32_flat32 },
+	{ 0xc7, MOV_EdId_flat32 },
+	{ 0xe8, CALL_Ad_flat32 },
+	{ 0xeb, JMP_Jb_flat32 },
+#if defined(USE_MACRO_FUSION)
+	{ 0x3d, CMP_EAXId_flat32 },
+	{ 0x48, DEC_EAX_flat32 },
+	{ 0x49, DEC_ECX_flat32 },
+	{ 0x4a, DEC_EDX_flat32 },
+	{ 0x4b, DEC_EBX_flat32 },
+	{ 0x4c, DEC_ESP_flat32 },
+	{ 0x4d, DEC_EBP_flat32 },
+	{ 0x4e, DEC_ESI_flat32 },
+	{ 0x4f, DEC_EDI_flat32 },
+	{ 0x55, PUSH_EBP_flat32 },
+	{ 0x81, Grp1_EdId_flat32 },
+	{ 0x83, Grp1_EdIb_flat32 },
+#endif
+};
+
+/* after fpu_initialize(), which patches insttable_1byte[] */
+void
+insttable_flat32_init(void)
+{
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		insttable_1byte_flat32[i] = insttable_1byte[1][i];
+	}
+	for (i = 0; i < (int)(sizeof(insttable_flat32_ops) / sizeof(insttable_flat32_ops[0])); i++) {
+		insttable_1byte_flat32[insttable_flat32_ops[i].op] =
+		    insttable_flat32_ops[i].func;
+	}
+}
+#endif
+
 
 void (*insttable_1byte_repfunc[2][256])(int reptype) = {
 	/* 16bit */
@@ -1085,8 +1169,8 @@ void (*insttable_1byte_repfunc[2][256])(int reptype) = {
 		STOSW_YwAX_rep,
 		NULL,
 		NULL,
-		NULL,
-		NULL,
+		SCASB_ALXb_rep,
+		SCASW_AXXw_rep,
 
 		NULL,		/* B0 */
 		NULL,
@@ -1360,8 +1444,8 @@ void (*insttable_1byte_repfunc[2][256])(int reptype) = {
 		STOSD_YdEAX_rep,
 		NULL,
 		NULL,
-		NULL,
-		NULL,
+		SCASB_ALXb_rep,
+		SCASD_EAXXd_rep,
 
 		NULL,		/* B0 */
 		NULL,
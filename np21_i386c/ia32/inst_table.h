@@ -49,6 +49,12 @@ extern void (*insttable_3byte660F3A_32[256])(void);
 extern void (*insttable_3byteF20F38_32[256])(void);
 extern void (*insttable_3byteF20F38_16[256])(void);
 
+#if defined(USE_FLAT32_TABLE)
+/* CPU_STAT_FLAT32 without prefix */
+extern void (*insttable_1byte_flat32[256])(void);
+void insttable_flat32_init(void);
+#endif
+
 /*
  * for group
  */
@@ -40,6 +40,11 @@ ARITH_INSTRUCTION_3(ADC)
 ARITH_INSTRUCTION_3(SUB)
 ARITH_INSTRUCTION_3(SBB)
 
+#if defined(USE_FLAT32_TABLE)
+ARITH_INSTRUCTION_3_FLAT32(ADD)
+ARITH_INSTRUCTION_3_FLAT32(SUB)
+#endif
+
 
 /*
  * IMUL
@@ -487,6 +492,18 @@ void DEC_EBP(void) { DWORD_DEC(CPU_EBP); CPU_WORKCLOCK(2); }
 void DEC_ESI(void) { DWORD_DEC(CPU_ESI); CPU_WORKCLOCK(2); }
 void DEC_EDI(void) { DWORD_DEC(CPU_EDI); CPU_WORKCLOCK(2); }
 
+#if defined(USE_MACRO_FUSION)
+/* CPU_STAT_FLAT32: dec reg; jcc */
+void DEC_EAX_flat32(void) { DWORD_DEC(CPU_EAX); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_ECX_flat32(void) { DWORD_DEC(CPU_ECX); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_EDX_flat32(void) { DWORD_DEC(CPU_EDX); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_EBX_flat32(void) { DWORD_DEC(CPU_EBX); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_ESP_flat32(void) { DWORD_DEC(CPU_ESP); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_EBP_flat32(void) { DWORD_DEC(CPU_EBP); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_ESI_flat32(void) { DWORD_DEC(CPU_ESI); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+void DEC_EDI_flat32(void) { DWORD_DEC(CPU_EDI); CPU_WORKCLOCK(2); FUSE_JCC_FLAGS(); }
+#endif
+
 
 /*
  * NEG
@@ -514,6 +531,9 @@ NEG4(UINT32 src, void *arg)
 	DWORD_NEG(dst, src);
 	return dst;
 }
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(NEG_RMW_b, b, UINT8, 1, NEG1)
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(NEG_RMW_w, w, UINT16, 2, NEG2)
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(NEG_RMW_d, d, UINT32, 4, NEG4)
 
 void CPUCALL
 NEG_Eb(UINT32 op)
@@ -530,7 +550,7 @@ NEG_Eb(UINT32 op)
 	} else {
 		CPU_WORKCLOCK(7);
 		madr = calc_ea_dst(op);
-		cpu_vmemory_RMW_b(CPU_INST_SEGREG_INDEX, madr, NEG1, 0);
+		NEG_RMW_b(CPU_INST_SEGREG_INDEX, madr, 0);
 	}
 }
 
@@ -549,7 +569,7 @@ NEG_Ew(UINT32 op)
 	} else {
 		CPU_WORKCLOCK(7);
 		madr = calc_ea_dst(op);
-		cpu_vmemory_RMW_w(CPU_INST_SEGREG_INDEX, madr, NEG2, 0);
+		NEG_RMW_w(CPU_INST_SEGREG_INDEX, madr, 0);
 	}
 }
 
@@ -568,7 +588,7 @@ NEG_Ed(UINT32 op)
 	} else {
 		CPU_WORKCLOCK(7);
 		madr = calc_ea_dst(op);
-		cpu_vmemory_RMW_d(CPU_INST_SEGREG_INDEX, madr, NEG4, 0);
+		NEG_RMW_d(CPU_INST_SEGREG_INDEX, madr, 0);
 	}
 }
 
@@ -580,7 +600,7 @@ void
 CMP_EbGb(void)
 {
 	UINT8 *out;
-	UINT32 op, src, dst, res, madr;
+	UINT32 op, src, dst, madr;
 
 	PREPART_EA_REG8(op, src);
 	if (op >= 0xc0) {
@@ -592,14 +612,14 @@ CMP_EbGb(void)
 		madr = calc_ea_dst(op);
 		dst = cpu_vmemoryread(CPU_INST_SEGREG_INDEX, madr);
 	}
-	BYTE_SUB(res, dst, src);
+	BYTE_CMP(dst, src);
 }
 
 void
 CMP_EwGw(void)
 {
 	UINT16 *out;
-	UINT32 op, src, dst, res, madr;
+	UINT32 op, src, dst, madr;
 
 	PREPART_EA_REG16(op, src);
 	if (op >= 0xc0) {
@@ -611,14 +631,14 @@ CMP_EwGw(void)
 		madr = calc_ea_dst(op);
 		dst = cpu_vmemoryread_w(CPU_INST_SEGREG_INDEX, madr);
 	}
-	WORD_SUB(res, dst, src);
+	WORD_CMP(dst, src);
 }
 
 void
 CMP_EdGd(void)
 {
 	UINT32 *out;
-	UINT32 op, src, dst, res, madr;
+	UINT32 op, src, dst, madr;
 
 	PREPART_EA_REG32(op, src);
 	if (op >= 0xc0) {
@@ -630,125 +650,176 @@ CMP_EdGd(void)
 		madr = calc_ea_dst(op);
 		dst = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, madr);
 	}
-	DWORD_SUB(res, dst, src);
+	DWORD_CMP(dst, src);
 }
 
 void
 CMP_GbEb(void)
 {
 	UINT8 *out;
-	UINT32 op, src, dst, res;
+	UINT32 op, src, dst;
 
 	PREPART_REG8_EA(op, src, out, 2, 5);
 	dst = *out;
-	BYTE_SUB(res, dst, src);
+	BYTE_CMP(dst, src);
 }
 
 void
 CMP_GwEw(void)
 {
 	UINT16 *out;
-	UINT32 op, src, dst, res;
+	UINT32 op, src, dst;
 
 	PREPART_REG16_EA(op, src, out, 2, 5);
 	dst = *out;
-	WORD_SUB(res, dst, src);
+	WORD_CMP(dst, src);
 }
 
 void
 CMP_GdEd(void)
 {
 	UINT32 *out;
-	UINT32 op, src, dst, res;
+	UINT32 op, src, dst;
 
 	PREPART_REG32_EA(op, src, out, 2, 5);
 	dst = *out;
-	DWORD_SUB(res, dst, src);
+	DWORD_CMP(dst, src);
 }
 
+#if defined(USE_FLAT32_TABLE)
+void
+CMP_EdGd_flat32(void)
+{
+	UINT32 *out;
+	UINT32 op, src, dst;
+
+	PREPART_EA_REG32(op, src);
+	if (op >= 0xc0) {
+		CPU_WORKCLOCK(2);
+		out = reg32_b20[op];
+		dst = *out;
+	} else {
+		CPU_WORKCLOCK(5);
+		dst = cpu_memoryread_d(calc_ea32_dst(op));
+	}
+	DWORD_CMP(dst, src);
+#if defined(USE_MACRO_FUSION)
+	FUSE_JCC_SUB_DWORD(dst, src);
+#endif
+}
+
+void
+CMP_GdEd_flat32(void)
+{
+	UINT32 *out;
+	UINT32 op, src, dst;
+
+	PREPART_REG32_EA_FLAT32(op, src, out, 2, 5);
+	dst = *out;
+	DWORD_CMP(dst, src);
+#if defined(USE_MACRO_FUSION)
+	FUSE_JCC_SUB_DWORD(dst, src);
+#endif
+}
+#endif
+
 void
 CMP_ALIb(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(2);
 	GET_PCBYTE(src);
 	dst = CPU_AL;
-	BYTE_SUB(res, dst, src);
+	BYTE_CMP(dst, src);
 }
 
 void
 CMP_AXIw(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(2);
 	GET_PCWORD(src);
 	dst = CPU_AX;
-	WORD_SUB(res, dst, src);
+	WORD_CMP(dst, src);
 }
 
 void
 CMP_EAXId(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
+
+	CPU_WORKCLOCK(2);
+	GET_PCDWORD(src);
+	dst = CPU_EAX;
+	DWORD_CMP(dst, src);
+}
+
+#if defined(USE_MACRO_FUSION)
+void
+CMP_EAXId_flat32(void)
+{
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(2);
 	GET_PCDWORD(src);
 	dst = CPU_EAX;
-	DWORD_SUB(res, dst, src);
+	DWORD_CMP(dst, src);
+	FUSE_JCC_SUB_DWORD(dst, src);
 }
+#endif
 
 void CPUCALL
 CMP_EbIb(UINT8 *regp, UINT32 src)
 {
-	UINT32 dst, res;
+	UINT32 dst;
 
 	dst = *regp;
-	BYTE_SUB(res, dst, src);
+	BYTE_CMP(dst, src);
 }
 
 void CPUCALL
 CMP_EbIb_ext(UINT32 madr, UINT32 src)
 {
-	UINT32 dst, res;
+	UINT32 dst;
 
 	dst = cpu_vmemoryread(CPU_INST_SEGREG_INDEX, madr);
-	BYTE_SUB(res, dst, src);
+	BYTE_CMP(dst, src);
 }
 
 void CPUCALL
 CMP_EwIx(UINT16 *regp, UINT32 src)
 {
-	UINT32 dst, res;
+	UINT32 dst;
 
 	dst = *regp;
-	WORD_SUB(res, dst, src);
+	WORD_CMP(dst, src);
 }
 
 void CPUCALL
 CMP_EwIx_ext(UINT32 madr, UINT32 src)
 {
-	UINT32 dst, res;
+	UINT32 dst;
 
 	dst = cpu_vmemoryread_w(CPU_INST_SEGREG_INDEX, madr);
-	WORD_SUB(res, dst, src);
+	WORD_CMP(dst, src);
 }
 
 void CPUCALL
 CMP_EdIx(UINT32 *regp, UINT32 src)
 {
-	UINT32 dst, res;
+	UINT32 dst;
 
 	dst = *regp;
-	DWORD_SUB(res, dst, src);
+	DWORD_CMP(dst, src);
 }
 
 void CPUCALL
 CMP_EdIx_ext(UINT32 madr, UINT32 src)
 {
-	UINT32 dst, res;
+	UINT32 dst;
 
 	dst = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, madr);
-	DWORD_SUB(res, dst, src);
+	DWORD_CMP(dst, src);
 }
@@ -188,6 +188,27 @@ void CPUCALL CMP_EbIb_ext(UINT32, UINT32);
 void CPUCALL CMP_EwIx_ext(UINT32, UINT32);
 void CPUCALL CMP_EdIx_ext(UINT32, UINT32);
 
+#if defined(USE_FLAT32_TABLE)
+/* CPU_STAT_FLAT32 */
+void ADD_EdGd_flat32(void);
+void ADD_GdEd_flat32(void);
+void SUB_EdGd_flat32(void);
+void SUB_GdEd_flat32(void);
+void CMP_EdGd_flat32(void);
+void CMP_GdEd_flat32(void);
+#if defined(USE_MACRO_FUSION)
+void CMP_EAXId_flat32(void);
+void DEC_EAX_flat32(void);
+void DEC_ECX_flat32(void);
+void DEC_EDX_flat32(void);
+void DEC_EBX_flat32(void);
+void DEC_ESP_flat32(void);
+void DEC_EBP_flat32(void);
+void DEC_ESI_flat32(void);
+void DEC_EDI_flat32(void);
+#endif
+#endif
+
 //#ifdef __cplusplus
 //}
 //#endif
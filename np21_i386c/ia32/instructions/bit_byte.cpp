@@ -560,7 +560,6 @@ BSF_GwEw(void)
 {
 	UINT16 *out;
 	UINT32 op, src;
-	int bit;
 
 	PREPART_REG16_EA(op, src, out, 2, 7);
 	if (src == 0) {
@@ -568,11 +567,7 @@ BSF_GwEw(void)
 		/* dest reg is undefined */
 	} else {
 		CPU_FLAGL &= ~Z_FLAG;
-		for (bit = 0; bit < 15; bit++) {
-			if (src & (1 << bit))
-				break;
-		}
-		*out = (UINT16)bit;
+		*out = (UINT16)bitscan_forward32(src);
 	}
 }
 
@@ -581,7 +576,6 @@ BSF_GdEd(void)
 {
 	UINT32 *out;
 	UINT32 op, src;
-	int bit;
 
 	PREPART_REG32_EA(op, src, out, 2, 7);
 	if (src == 0) {
@@ -589,11 +583,7 @@ BSF_GdEd(void)
 		/* dest reg is undefined */
 	} else {
 		CPU_FLAGL &= ~Z_FLAG;
-		for (bit = 0; bit < 31; bit++) {
-			if (src & (1 << bit))
-				break;
-		}
-		*out = (UINT32)bit;
+		*out = bitscan_forward32(src);
 	}
 }
 
@@ -605,7 +595,6 @@ BSR_GwEw(void)
 {
 	UINT16 *out;
 	UINT32 op, src;
-	int bit;
 
 	PREPART_REG16_EA(op, src, out, 2, 7);
 	if (src == 0) {
@@ -613,11 +602,7 @@ BSR_GwEw(void)
 		/* dest reg is undefined */
 	} else {
 		CPU_FLAGL &= ~Z_FLAG;
-		for (bit = 15; bit > 0; bit--) {
-			if (src & (1 << bit))
-				break;
-		}
-		*out = (UINT16)bit;
+		*out = (UINT16)bitscan_reverse32(src);
 	}
 }
 
@@ -626,7 +611,6 @@ BSR_GdEd(void)
 {
 	UINT32 *out;
 	UINT32 op, src;
-	int bit;
 
 	PREPART_REG32_EA(op, src, out, 2, 7);
 	if (src == 0) {
@@ -634,11 +618,7 @@ BSR_GdEd(void)
 		/* dest reg is undefined */
 	} else {
 		CPU_FLAGL &= ~Z_FLAG;
-		for (bit = 31; bit > 0; bit--) {
-			if (src & (1 << bit))
-				break;
-		}
-		*out = (UINT32)bit;
+		*out = bitscan_reverse32(src);
 	}
 }
 
@@ -971,6 +951,27 @@ TEST_EdGd(void)
 	DWORD_AND(tmp, src);
 }
 
+#if defined(USE_FLAT32_TABLE)
+void
+TEST_EdGd_flat32(void)
+{
+	UINT32 op, src, tmp;
+
+	PREPART_EA_REG32(op, src);
+	if (op >= 0xc0) {
+		CPU_WORKCLOCK(2);
+		tmp = *(reg32_b20[op]);
+	} else {
+		CPU_WORKCLOCK(7);
+		tmp = cpu_memoryread_d(calc_ea32_dst(op));
+	}
+	DWORD_AND(tmp, src);
+#if defined(USE_MACRO_FUSION)
+	FUSE_JCC_LOG_DWORD(tmp);
+#endif
+}
+#endif
+
 void
 TEST_ALIb(void)
 {
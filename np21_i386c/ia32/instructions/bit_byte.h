@@ -92,6 +92,10 @@ void CPUCALL TEST_EbIb(UINT32);
 void CPUCALL TEST_EwIw(UINT32);
 void CPUCALL TEST_EdId(UINT32);
 
+#if defined(USE_FLAT32_TABLE)
+void TEST_EdGd_flat32(void);	/* CPU_STAT_FLAT32 */
+#endif
+
 //#ifdef __cplusplus
 //}
 //#endif
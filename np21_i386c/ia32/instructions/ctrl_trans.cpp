@@ -770,6 +770,44 @@ JNLE_Jd(void)
 	}
 }
 
+#if defined(USE_FLAT32_TABLE)
+/*
+ * CPU_STAT_FLAT32: 32bit operand size and a 4GB CS limit, so the target
+ * is neither masked nor checked.
+ */
+#define	JCC_JB_FLAT32(inst, cc) \
+void \
+inst##_Jb_flat32(void) \
+{ \
+\
+	JCCSHORT_FLAT32(cc); \
+}
+
+void
+JMP_Jb_flat32(void)
+{
+
+	JMPSHORT_FLAT32(7);
+}
+
+JCC_JB_FLAT32(JO, CC_O)
+JCC_JB_FLAT32(JNO, CC_NO)
+JCC_JB_FLAT32(JC, CC_C)
+JCC_JB_FLAT32(JNC, CC_NC)
+JCC_JB_FLAT32(JZ, CC_Z)
+JCC_JB_FLAT32(JNZ, CC_NZ)
+JCC_JB_FLAT32(JNA, CC_NA)
+JCC_JB_FLAT32(JA, CC_A)
+JCC_JB_FLAT32(JS, CC_S)
+JCC_JB_FLAT32(JNS, CC_NS)
+JCC_JB_FLAT32(JP, CC_P)
+JCC_JB_FLAT32(JNP, CC_NP)
+JCC_JB_FLAT32(JL, CC_L)
+JCC_JB_FLAT32(JNL, CC_NL)
+JCC_JB_FLAT32(JLE, CC_LE)
+JCC_JB_FLAT32(JNLE, CC_NLE)
+#endif
+
 /* jcxz */
 void
 JeCXZ_Jb(void)
@@ -907,6 +945,21 @@ CALL_Ad(void)
 	CPU_CLEAR_PREV_ESP();
 }
 
+#if defined(USE_FLAT32_TABLE)
+void
+CALL_Ad_flat32(void)
+{
+	UINT32 dest;
+
+	CPU_WORKCLOCK(7);
+	CPU_SET_PREV_ESP();
+	GET_PCDWORD(dest);
+	REGPUSH0_32(CPU_EIP);	/* flat 32bit stack */
+	CPU_EIP += dest;
+	CPU_CLEAR_PREV_ESP();
+}
+#endif
+
 void CPUCALL
 CALL_Ew(UINT32 op)
 {
@@ -1122,6 +1175,18 @@ RETnear32(void)
 	CPU_CLEAR_PREV_ESP();
 }
 
+#if defined(USE_FLAT32_TABLE)
+void
+RETnear32_flat32(void)
+{
+
+	CPU_WORKCLOCK(11);
+	CPU_SET_PREV_ESP();
+	REGPOP0_32(CPU_EIP);	/* flat 32bit stack */
+	CPU_CLEAR_PREV_ESP();
+}
+#endif
+
 void
 RETnear16_Iw(void)
 {
@@ -1525,8 +1590,8 @@ ENTER16_IwIb(void)
 				while (level--) {
 					bp -= 2;
 					CPU_ESP -= 2;
-					val = cpu_vmemoryread_w(CPU_SS_INDEX, bp);
-					cpu_vmemorywrite_w(CPU_SS_INDEX, CPU_ESP, (UINT16)val);
+					val = SS32_VMEMORYREAD(w, bp);
+					SS32_VMEMORYWRITE(w, CPU_ESP, (UINT16)val);
 				}
 				REGPUSH0_16_32(new_bp);
 				CPU_BP = new_bp;
@@ -1580,8 +1645,8 @@ ENTER32_IwIb(void)
 				while (level--) {
 					bp -= 4;
 					CPU_ESP -= 4;
-					val = cpu_vmemoryread_d(CPU_SS_INDEX, bp);
-					cpu_vmemorywrite_d(CPU_SS_INDEX, CPU_ESP, val);
+					val = SS32_VMEMORYREAD(d, bp);
+					SS32_VMEMORYWRITE(d, CPU_ESP, val);
 				}
 				REGPUSH0_32(new_bp);
 				CPU_EBP = new_bp;
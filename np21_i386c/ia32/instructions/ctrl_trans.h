@@ -96,6 +96,27 @@ void JNLE_Jw(void);
 void JNLE_Jd(void);
 void JeCXZ_Jb(void);
 
+#if defined(USE_FLAT32_TABLE)
+/* CPU_STAT_FLAT32 */
+void JMP_Jb_flat32(void);
+void JO_Jb_flat32(void);
+void JNO_Jb_flat32(void);
+void JC_Jb_flat32(void);
+void JNC_Jb_flat32(void);
+void JZ_Jb_flat32(void);
+void JNZ_Jb_flat32(void);
+void JNA_Jb_flat32(void);
+void JA_Jb_flat32(void);
+void JS_Jb_flat32(void);
+void JNS_Jb_flat32(void);
+void JP_Jb_flat32(void);
+void JNP_Jb_flat32(void);
+void JL_Jb_flat32(void);
+void JNL_Jb_flat32(void);
+void JLE_Jb_flat32(void);
+void JNLE_Jb_flat32(void);
+#endif
+
 /*
  * LOOPcc
  */
@@ -108,6 +129,9 @@ void LOOP_Jb(void);
  */
 void CALL_Aw(void);
 void CALL_Ad(void);
+#if defined(USE_FLAT32_TABLE)
+void CALL_Ad_flat32(void);	/* CPU_STAT_FLAT32 */
+#endif
 void CPUCALL CALL_Ew(UINT32);
 void CPUCALL CALL_Ed(UINT32);
 void CALL16_Ap(void);
@@ -120,6 +144,9 @@ void CPUCALL CALL32_Ep(UINT32);
  */
 void RETnear16(void);
 void RETnear32(void);
+#if defined(USE_FLAT32_TABLE)
+void RETnear32_flat32(void);	/* CPU_STAT_FLAT32 */
+#endif
 void RETnear16_Iw(void);
 void RETnear32_Iw(void);
 void RETfar16(void);
@@ -353,6 +353,99 @@ void MOV_EBPId(void) { CPU_WORKCLOCK(2); GET_PCDWORD(CPU_EBP); }
 void MOV_ESIId(void) { CPU_WORKCLOCK(2); GET_PCDWORD(CPU_ESI); }
 void MOV_EDIId(void) { CPU_WORKCLOCK(2); GET_PCDWORD(CPU_EDI); }
 
+#if defined(USE_FLAT32_TABLE)
+/*
+ * CPU_STAT_FLAT32: no prefix, flat segments and no paging
+ */
+void
+MOV_EbGb_flat32(void)
+{
+	UINT32 op, src;
+
+	PREPART_EA_REG8(op, src);
+	if (op >= 0xc0) {
+		CPU_WORKCLOCK(2);
+		*(reg8_b20[op]) = (UINT8)src;
+	} else {
+		CPU_WORKCLOCK(3);
+		cpu_memorywrite(calc_ea32_dst(op), (UINT8)src);
+	}
+}
+
+void
+MOV_EdGd_flat32(void)
+{
+	UINT32 op, src;
+
+	PREPART_EA_REG32(op, src);
+	if (op >= 0xc0) {
+		CPU_WORKCLOCK(2);
+		*(reg32_b20[op]) = src;
+	} else {
+		CPU_WORKCLOCK(3);
+		cpu_memorywrite_d(calc_ea32_dst(op), src);
+	}
+}
+
+void
+MOV_GbEb_flat32(void)
+{
+	UINT8 *out;
+	UINT32 op, src;
+
+	PREPART_REG8_EA_FLAT32(op, src, out, 2, 5);
+	*out = (UINT8)src;
+}
+
+void
+MOV_GdEd_flat32(void)
+{
+	UINT32 *out;
+	UINT32 op, src;
+
+	PREPART_REG32_EA_FLAT32(op, src, out, 2, 5);
+	*out = src;
+}
+
+void
+MOV_EAXOd_flat32(void)
+{
+	UINT32 madr;
+
+	CPU_WORKCLOCK(5);
+	GET_PCDWORD(madr);
+	CPU_EAX = cpu_memoryread_d(madr);
+}
+
+void
+MOV_OdEAX_flat32(void)
+{
+	UINT32 madr;
+
+	CPU_WORKCLOCK(3);
+	GET_PCDWORD(madr);
+	cpu_memorywrite_d(madr, CPU_EAX);
+}
+
+void
+MOV_EdId_flat32(void)
+{
+	UINT32 op, res, madr;
+
+	GET_PCBYTE(op);
+	if (op >= 0xc0) {
+		CPU_WORKCLOCK(2);
+		GET_PCDWORD(res);
+		*(reg32_b20[op]) = res;
+	} else {
+		CPU_WORKCLOCK(7);
+		madr = calc_ea32_dst(op);
+		GET_PCDWORD(res);
+		cpu_memorywrite_d(madr, res);
+	}
+}
+#endif
+
 /*
  * CMOVcc
  */
@@ -750,6 +843,9 @@ XCHG(UINT32 dst, void *arg)
 	(void)dst;
 	return src;
 }
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(XCHG_RMW_b, b, UINT8, 1, XCHG)
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(XCHG_RMW_w, w, UINT16, 2, XCHG)
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(XCHG_RMW_d, d, UINT32, 4, XCHG)
 
 void
 XCHG_EbGb(void)
@@ -765,7 +861,7 @@ XCHG_EbGb(void)
 	} else {
 		CPU_WORKCLOCK(5);
 		madr = calc_ea_dst(op);
-		*src = (UINT8)cpu_vmemory_RMW_b(CPU_INST_SEGREG_INDEX, madr, XCHG, UINT32_TO_PTR(*src));
+		*src = (UINT8)XCHG_RMW_b(CPU_INST_SEGREG_INDEX, madr, UINT32_TO_PTR(*src));
 	}
 }
 
@@ -783,7 +879,7 @@ XCHG_EwGw(void)
 	} else {
 		CPU_WORKCLOCK(5);
 		madr = calc_ea_dst(op);
-		*src = (UINT16)cpu_vmemory_RMW_w(CPU_INST_SEGREG_INDEX, madr, XCHG, UINT32_TO_PTR(*src));
+		*src = (UINT16)XCHG_RMW_w(CPU_INST_SEGREG_INDEX, madr, UINT32_TO_PTR(*src));
 	}
 }
 
@@ -801,7 +897,7 @@ XCHG_EdGd(void)
 	} else {
 		CPU_WORKCLOCK(5);
 		madr = calc_ea_dst(op);
-		*src = cpu_vmemory_RMW_d(CPU_INST_SEGREG_INDEX, madr, XCHG, UINT32_TO_PTR(*src));
+		*src = XCHG_RMW_d(CPU_INST_SEGREG_INDEX, madr, UINT32_TO_PTR(*src));
 	}
 }
 
@@ -875,6 +971,9 @@ XADD4(UINT32 dst, void *arg)
 	DWORD_ADD(res, dst, src);
 	return res;
 }
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(XADD_RMW_b, b, UINT8, 1, XADD1)
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(XADD_RMW_w, w, UINT16, 2, XADD2)
+DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(XADD_RMW_d, d, UINT32, 4, XADD4)
 
 void
 XADD_EbGb(void)
@@ -893,7 +992,7 @@ XADD_EbGb(void)
 	} else {
 		CPU_WORKCLOCK(7);
 		madr = calc_ea_dst(op);
-		*src = (UINT8)cpu_vmemory_RMW_b(CPU_INST_SEGREG_INDEX, madr, XADD1, UINT32_TO_PTR(*src));
+		*src = (UINT8)XADD_RMW_b(CPU_INST_SEGREG_INDEX, madr, UINT32_TO_PTR(*src));
 	}
 }
 
@@ -914,7 +1013,7 @@ XADD_EwGw(void)
 	} else {
 		CPU_WORKCLOCK(7);
 		madr = calc_ea_dst(op);
-		*src = (UINT16)cpu_vmemory_RMW_w(CPU_INST_SEGREG_INDEX, madr, XADD2, UINT32_TO_PTR(*src));
+		*src = (UINT16)XADD_RMW_w(CPU_INST_SEGREG_INDEX, madr, UINT32_TO_PTR(*src));
 	}
 }
 
@@ -935,7 +1034,7 @@ XADD_EdGd(void)
 	} else {
 		CPU_WORKCLOCK(7);
 		madr = calc_ea_dst(op);
-		*src = cpu_vmemory_RMW_d(CPU_INST_SEGREG_INDEX, madr, XADD4, UINT32_TO_PTR(*src));
+		*src = XADD_RMW_d(CPU_INST_SEGREG_INDEX, madr, UINT32_TO_PTR(*src));
 	}
 }
 
@@ -946,7 +1045,7 @@ void
 CMPXCHG_EbGb(void)
 {
 	UINT8 *out;
-	UINT32 op, src, dst, madr, tmp;
+	UINT32 op, src, dst, madr;
 	UINT8 al;
 
 	PREPART_EA_REG8(op, src);
@@ -968,14 +1067,14 @@ CMPXCHG_EbGb(void)
 			CPU_AL = (UINT8)dst;
 		}
 	}
-	BYTE_SUB(tmp, al, dst);
+	BYTE_CMP(al, dst);
 }
 
 void
 CMPXCHG_EwGw(void)
 {
 	UINT16 *out;
-	UINT32 op, src, dst, madr, tmp;
+	UINT32 op, src, dst, madr;
 	UINT16 ax;
 
 	PREPART_EA_REG16(op, src);
@@ -997,14 +1096,14 @@ CMPXCHG_EwGw(void)
 			CPU_AX = (UINT16)dst;
 		}
 	}
-	WORD_SUB(tmp, ax, dst);
+	WORD_CMP(ax, dst);
 }
 
 void
 CMPXCHG_EdGd(void)
 {
 	UINT32 *out;
-	UINT32 op, src, dst, madr, tmp;
+	UINT32 op, src, dst, madr;
 	UINT32 eax;
 
 	PREPART_EA_REG32(op, src);
@@ -1026,7 +1125,7 @@ CMPXCHG_EdGd(void)
 			CPU_EAX = dst;
 		}
 	}
-	DWORD_SUB(tmp, eax, dst);
+	DWORD_CMP(eax, dst);
 }
 
 void CPUCALL
@@ -1074,6 +1173,24 @@ void PUSH_EBP(void) { CPU_WORKCLOCK(3); PUSH0_32(CPU_EBP); }
 void PUSH_ESI(void) { CPU_WORKCLOCK(3); PUSH0_32(CPU_ESI); }
 void PUSH_EDI(void) { CPU_WORKCLOCK(3); PUSH0_32(CPU_EDI); }
 
+#if defined(USE_MACRO_FUSION)
+/* CPU_STAT_FLAT32: push ebp; mov ebp, esp */
+void
+PUSH_EBP_flat32(void)
+{
+	SINT32 op;
+
+	CPU_WORKCLOCK(3);
+	REGPUSH0_32(CPU_EBP);	/* flat 32bit stack */
+	op = cpu_codepeek_w(CPU_EIP);	/* the push is done, must not fault */
+	if (op == 0xe589 || op == 0xec8b) {
+		CPU_WORKCLOCK(2);
+		CPU_EIP += 2;
+		CPU_EBP = CPU_ESP;
+	}
+}
+#endif
+
 void CPUCALL
 PUSH_Ew(UINT32 op)
 {
@@ -76,6 +76,17 @@ void MOV_EBPId(void);
 void MOV_ESIId(void);
 void MOV_EDIId(void);
 
+#if defined(USE_FLAT32_TABLE)
+/* CPU_STAT_FLAT32 */
+void MOV_EbGb_flat32(void);
+void MOV_EdGd_flat32(void);
+void MOV_GbEb_flat32(void);
+void MOV_GdEd_flat32(void);
+void MOV_EAXOd_flat32(void);
+void MOV_OdEAX_flat32(void);
+void MOV_EdId_flat32(void);
+#endif
+
 /*
  * CMOVcc
  */
@@ -179,6 +190,9 @@ void PUSH_ESP(void);
 void PUSH_EBP(void);
 void PUSH_ESI(void);
 void PUSH_EDI(void);
+#if defined(USE_MACRO_FUSION)
+void PUSH_EBP_flat32(void);	/* CPU_STAT_FLAT32 */
+#endif
 void PUSH_Ib(void);
 void PUSH_Iw(void);
 void PUSH_Id(void);
@@ -320,6 +320,36 @@ fpu_memorywrite_f64(UINT32 address, double value)
 	FPU_DATAPTR_OFFSET = address;
 	cpu_vmemorywrite_q(seg, address, val.q);
 }
+
+void MEMCALL
+fpu_memoryread_block(UINT32 address, void *data, UINT length)
+{
+	UINT16 seg;
+
+	FPU_DATAPTR_SEG = seg = CPU_INST_SEGREG_INDEX;
+	FPU_DATAPTR_OFFSET = address;
+	cpu_vmemoryread_block(seg, address, data, length);
+}
+
+void MEMCALL
+fpu_memorywrite_block(UINT32 address, const void *data, UINT length)
+{
+	UINT16 seg;
+
+	FPU_DATAPTR_SEG = seg = CPU_INST_SEGREG_INDEX;
+	FPU_DATAPTR_OFFSET = address;
+	cpu_vmemorywrite_block(seg, address, data, length);
+}
+
+UINT8 * MEMCALL
+fpu_memory_hostptr(UINT32 address, UINT length, int ucrw)
+{
+	UINT16 seg;
+
+	FPU_DATAPTR_SEG = seg = CPU_INST_SEGREG_INDEX;
+	FPU_DATAPTR_OFFSET = address;
+	return cpu_vmemory_hostptr(seg, address, length, ucrw);
+}
 #endif
 
 void
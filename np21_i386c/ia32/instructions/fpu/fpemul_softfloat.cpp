@@ -240,18 +240,34 @@ static floatx80 FROUND(floatx80 in){
 #define BIAS80 16383
 #define BIAS64 1023
 
+static void FPU_FLD80_VAL(const REG80 *value, UINT reg) 
+{
+	FPU_STAT.reg[reg].ul.lower = value->d.l[0];
+	FPU_STAT.reg[reg].ul.upper = value->d.l[1];
+	FPU_STAT.reg[reg].ul.ext = value->d.h;
+}
+
+static void FPU_ST80_VAL(REG80 *value, UINT reg) 
+{
+	value->d.l[0] = FPU_STAT.reg[reg].ul.lower;
+	value->d.l[1] = FPU_STAT.reg[reg].ul.upper;
+	value->d.h = FPU_STAT.reg[reg].ul.ext;
+}
+
 static void FPU_FLD80(UINT32 addr, UINT reg) 
 {
-	FPU_STAT.reg[reg].ul.lower = fpu_memoryread_d(addr);
-	FPU_STAT.reg[reg].ul.upper = fpu_memoryread_d(addr+4);
-	FPU_STAT.reg[reg].ul.ext = fpu_memoryread_w(addr+8);
+	REG80 value;
+
+	value = fpu_memoryread_f(addr);
+	FPU_FLD80_VAL(&value, reg);
 }
 
 static void FPU_ST80(UINT32 addr,UINT reg) 
 {
-	fpu_memorywrite_d(addr,FPU_STAT.reg[reg].ul.lower);
-	fpu_memorywrite_d(addr+4,FPU_STAT.reg[reg].ul.upper);
-	fpu_memorywrite_w(addr+8,FPU_STAT.reg[reg].ul.ext);
+	REG80 value;
+
+	FPU_ST80_VAL(&value, reg);
+	fpu_memorywrite_f(addr, &value);
 }
 
 
@@ -789,138 +805,188 @@ static void FPU_FSCALE(void){
 	return; //2^x where x is chopped.
 }
 
-static void FPU_FSTENV(UINT32 addr)
+static UINT FPU_STENV_IMAGE(UINT8 *p)
 {
+	UINT16 tag;
+
 //	descriptor_t *sdp = &CPU_CS_DESC;	
 	FPU_SET_TOP(FPU_STAT_TOP);
+	tag = FPU_GetTag();
 	
 //	switch ((CPU_CR0 & 1) | (SEG_IS_32BIT(sdp) ? 0x100 : 0x000))
 	switch ((CPU_CR0 & 1) | (CPU_INST_OP32 ? 0x100 : 0x000))
 	{
 	case 0x000: case 0x001:
-		fpu_memorywrite_w(addr+0,FPU_CTRLWORD);
-		fpu_memorywrite_w(addr+2,FPU_STATUSWORD);
-		fpu_memorywrite_w(addr+4,FPU_GetTag());
-		fpu_memorywrite_w(addr+10,FPU_LASTINSTOP);
-		break;
+		memset(p, 0, FPU_ENV_SIZE(0));
+		STOREINTELWORD(p+0,FPU_CTRLWORD);
+		STOREINTELWORD(p+2,FPU_STATUSWORD);
+		STOREINTELWORD(p+4,tag);
+		STOREINTELWORD(p+10,FPU_LASTINSTOP);
+		return FPU_ENV_SIZE(0);
 		
-	case 0x100: case 0x101:
-		fpu_memorywrite_d(addr+0,(UINT32)(FPU_CTRLWORD));
-		fpu_memorywrite_d(addr+4,(UINT32)(FPU_STATUSWORD));
-		fpu_memorywrite_d(addr+8,(UINT32)(FPU_GetTag()));	
-		fpu_memorywrite_d(addr+20,FPU_LASTINSTOP);			
-		break;
+	default:
+		memset(p, 0, FPU_ENV_SIZE(1));
+		STOREINTELDWORD(p+0,(UINT32)(FPU_CTRLWORD));
+		STOREINTELDWORD(p+4,(UINT32)(FPU_STATUSWORD));
+		STOREINTELDWORD(p+8,(UINT32)(tag));
+		STOREINTELDWORD(p+20,(UINT32)(FPU_LASTINSTOP));
+		return FPU_ENV_SIZE(1);
 	}
 }
 
-static void FPU_FLDENV(UINT32 addr)
+static UINT FPU_LDENV_IMAGE(const UINT8 *p)
 {
+	UINT size;
+
 //	descriptor_t *sdp = &CPU_CS_DESC;	
 	
 //	switch ((CPU_CR0 & 1) | (SEG_IS_32BIT(sdp) ? 0x100 : 0x000)) {
 	switch ((CPU_CR0 & 1) | (CPU_INST_OP32 ? 0x100 : 0x000)) {
 	case 0x000: case 0x001:
-		FPU_SetCW(fpu_memoryread_w(addr+0));
-		FPU_STATUSWORD = fpu_memoryread_w(addr+2);
-		FPU_SetTag(fpu_memoryread_w(addr+4));
-		FPU_LASTINSTOP = fpu_memoryread_w(addr+10);
+		FPU_SetCW(LOADINTELWORD(p+0));
+		FPU_STATUSWORD = LOADINTELWORD(p+2);
+		FPU_SetTag(LOADINTELWORD(p+4));
+		FPU_LASTINSTOP = LOADINTELWORD(p+10);
+		size = FPU_ENV_SIZE(0);
 		break;
 		
-	case 0x100: case 0x101:
-		FPU_SetCW((UINT16)fpu_memoryread_d(addr+0));
-		FPU_STATUSWORD = (UINT16)fpu_memoryread_d(addr+4);
-		FPU_SetTag((UINT16)fpu_memoryread_d(addr+8));
-		FPU_LASTINSTOP = (UINT16)fpu_memoryread_d(addr+20);		
+	default:
+		FPU_SetCW((UINT16)LOADINTELDWORD(p+0));
+		FPU_STATUSWORD = (UINT16)LOADINTELDWORD(p+4);
+		FPU_SetTag((UINT16)LOADINTELDWORD(p+8));
+		FPU_LASTINSTOP = (UINT16)LOADINTELDWORD(p+20);
+		size = FPU_ENV_SIZE(1);
 		break;
 	}
 	FPU_STAT_TOP = FPU_GET_TOP();
+	return size;
+}
+
+static void FPU_FSTENV(UINT32 addr)
+{
+	UINT8 image[FPU_ENV_SIZE(1)];
+	UINT size;
+
+	size = FPU_STENV_IMAGE(image);
+	fpu_memorywrite_block(addr, image, size);
+}
+
+static void FPU_FLDENV(UINT32 addr)
+{
+	UINT8 image[FPU_ENV_SIZE(1)];
+
+	fpu_memoryread_block(addr, image, FPU_ENV_SIZE(CPU_INST_OP32));
+	FPU_LDENV_IMAGE(image);
 }
 
 static void FPU_FSAVE(UINT32 addr)
 {
-	UINT start;
+	UINT8 image[FPU_FSAVE_SIZE_MAX], *p;
+	REG80 value;
+	UINT start, size;
 	UINT i;
 	
-//	descriptor_t *sdp = &CPU_CS_DESC;
-	
-	FPU_FSTENV(addr);
-//	start = ((SEG_IS_32BIT(sdp))?28:14);
-	start = ((CPU_INST_OP32)?28:14);
+	size = FPU_FSAVE_SIZE(CPU_INST_OP32);
+	p = fpu_memory_hostptr(addr, size, CPU_PAGE_WRITE_DATA);
+	if (p == NULL)
+		p = image;
+
+	start = FPU_STENV_IMAGE(p);
 	for(i = 0;i < 8;i++){
-		FPU_ST80(addr+start,FPU_ST(i));
+		FPU_ST80_VAL(&value, FPU_ST(i));
+		fpu_image_store80(p+start, &value);
 		start += 10;
 	}
+	if (p == image)
+		fpu_memorywrite_block(addr, image, size);
 	FPU_FINIT();
 }
 
 static void FPU_FRSTOR(UINT32 addr)
 {
-	UINT start;
+	UINT8 image[FPU_FSAVE_SIZE_MAX], *p;
+	REG80 value;
+	UINT start, size;
 	UINT i;
 	
-//	descriptor_t *sdp = &CPU_CS_DESC;
-	
-	FPU_FLDENV(addr);
-//	start = ((SEG_IS_32BIT(sdp))?28:14);
-	start = ((CPU_INST_OP32)?28:14);
+	size = FPU_FSAVE_SIZE(CPU_INST_OP32);
+	p = fpu_memory_hostptr(addr, size, CPU_PAGE_READ_DATA);
+	if (p == NULL) {
+		fpu_memoryread_block(addr, image, size);
+		p = image;
+	}
+
+	start = FPU_LDENV_IMAGE(p);
 	for(i = 0;i < 8;i++){
-		FPU_FLD80(addr+start, FPU_ST(i));
+		fpu_image_load80(p+start, &value);
+		FPU_FLD80_VAL(&value, FPU_ST(i));
 		start += 10;
 	}
 }
 
 static void FPU_FXSAVE(UINT32 addr){
+	UINT8 image[FPU_FXSAVE_SIZE], *p;
+	REG80 value;
 	UINT start;
 	UINT i;
 	
-//	descriptor_t *sdp = &CPU_CS_DESC;
-	
-	//FPU_FSTENV(addr);
+	p = fpu_memory_hostptr(addr, FPU_FXSAVE_SIZE, CPU_PAGE_WRITE_DATA);
+	if (p == NULL)
+		p = image;
+	memset(p, 0, FPU_FXSAVE_SIZE);
+
 	FPU_SET_TOP(FPU_STAT_TOP);
-	fpu_memorywrite_w(addr+0,FPU_CTRLWORD);
-	fpu_memorywrite_w(addr+2,FPU_STATUSWORD);
-	fpu_memorywrite_b(addr+4,FPU_GetTag8());
+	STOREINTELWORD(p+0,FPU_CTRLWORD);
+	STOREINTELWORD(p+2,FPU_STATUSWORD);
+	p[4] = FPU_GetTag8();
 #ifdef USE_SSE
-	fpu_memorywrite_d(addr+24,SSE_MXCSR);
+	STOREINTELDWORD(p+24,SSE_MXCSR);
 #endif
 	start = 32;
 	for(i = 0;i < 8;i++){
-		FPU_ST80(addr+start, FPU_ST(i));
+		FPU_ST80_VAL(&value, FPU_ST(i));
+		fpu_image_store80(p+start, &value);
 		start += 16;
 	}
 #ifdef USE_SSE
 	start = 160;
 	for(i = 0;i < 8;i++){
-		fpu_memorywrite_q(addr+start+0,SSE_XMMREG(i).ul64[0]);
-		fpu_memorywrite_q(addr+start+8,SSE_XMMREG(i).ul64[1]);
+		memcpy(p+start, &SSE_XMMREG(i), 16);
 		start += 16;
 	}
 #endif
+	if (p == image)
+		fpu_memorywrite_block(addr, image, FPU_FXSAVE_SIZE);
 }
 static void FPU_FXRSTOR(UINT32 addr){
+	UINT8 image[FPU_FXSAVE_SIZE], *p;
+	REG80 value;
 	UINT start;
 	UINT i;
 	
-//	descriptor_t *sdp = &CPU_CS_DESC;
-	
-	//FPU_FLDENV(addr);
-	FPU_SetCW(fpu_memoryread_w(addr+0));
-	FPU_STATUSWORD = fpu_memoryread_w(addr+2);
-	FPU_SetTag8(fpu_memoryread_b(addr+4));
+	p = fpu_memory_hostptr(addr, FPU_FXSAVE_SIZE, CPU_PAGE_READ_DATA);
+	if (p == NULL) {
+		fpu_memoryread_block(addr, image, FPU_FXSAVE_SIZE);
+		p = image;
+	}
+
+	FPU_SetCW(LOADINTELWORD(p+0));
+	FPU_STATUSWORD = LOADINTELWORD(p+2);
+	FPU_SetTag8(p[4]);
 	FPU_STAT_TOP = FPU_GET_TOP();
 #ifdef USE_SSE
-	SSE_MXCSR = fpu_memoryread_d(addr+24);
+	SSE_MXCSR = LOADINTELDWORD(p+24);
 #endif
 	start = 32;
 	for(i = 0;i < 8;i++){
-		FPU_FLD80(addr+start, FPU_ST(i));
+		fpu_image_load80(p+start, &value);
+		FPU_FLD80_VAL(&value, FPU_ST(i));
 		start += 16;
 	}
 #ifdef USE_SSE
 	start = 160;
 	for(i = 0;i < 8;i++){
-		SSE_XMMREG(i).ul64[0] = fpu_memoryread_q(addr+start+0);
-		SSE_XMMREG(i).ul64[1] = fpu_memoryread_q(addr+start+8);
+		memcpy(&SSE_XMMREG(i), p+start, 16);
 		start += 16;
 	}
 #endif
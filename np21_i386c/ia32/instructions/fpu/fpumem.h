@@ -75,6 +75,47 @@ fpu_memorywrite_f32(UINT32 address, float value);
 void MEMCALL
 fpu_memorywrite_f64(UINT32 address, double value);
 
+/*
+ * FPU state image (FSTENV/FSAVE/FXSAVE and the restores)
+ *
+ * The image is built in a host buffer and moved with one block transfer.
+ * fpu_memory_hostptr() returns the guest buffer itself when it is plain
+ * host memory, and the image is then built in place.
+ */
+#define	FPU_ENV_SIZE(op32)	((op32) ? 28 : 14)
+#define	FPU_FSAVE_SIZE(op32)	(FPU_ENV_SIZE(op32) + 8 * 10)
+#define	FPU_FSAVE_SIZE_MAX	FPU_FSAVE_SIZE(1)
+#if defined(USE_SSE)
+#define	FPU_FXSAVE_SIZE		(160 + 8 * 16)	/* up to XMM7 */
+#else
+#define	FPU_FXSAVE_SIZE		160
+#endif
+
+void MEMCALL
+fpu_memoryread_block(UINT32 address, void *data, UINT length);
+
+void MEMCALL
+fpu_memorywrite_block(UINT32 address, const void *data, UINT length);
+
+UINT8 * MEMCALL
+fpu_memory_hostptr(UINT32 address, UINT length, int ucrw);
+
+STATIC_INLINE void
+fpu_image_store80(UINT8 *p, const REG80 *value)
+{
+	STOREINTELDWORD(p + 0, value->d.l[0]);
+	STOREINTELDWORD(p + 4, value->d.l[1]);
+	STOREINTELWORD(p + 8, value->d.h);
+}
+
+STATIC_INLINE void
+fpu_image_load80(const UINT8 *p, REG80 *value)
+{
+	value->d.l[0] = LOADINTELDWORD(p + 0);
+	value->d.l[1] = LOADINTELDWORD(p + 4);
+	value->d.h = LOADINTELWORD(p + 8);
+}
+
 //#ifdef __cplusplus
 //}
 //#endif
@@ -46,6 +46,12 @@ ARITH_INSTRUCTION_2(OR)
  */
 ARITH_INSTRUCTION_2(XOR)
 
+#if defined(USE_FLAT32_TABLE)
+ARITH_INSTRUCTION_2_FLAT32(AND)
+ARITH_INSTRUCTION_2_FLAT32(OR)
+ARITH_INSTRUCTION_2_FLAT32(XOR)
+#endif
+
 /*
  * NOT
  */
@@ -94,6 +94,18 @@ void CPUCALL NOT_Eb(UINT32);
 void CPUCALL NOT_Ew(UINT32);
 void CPUCALL NOT_Ed(UINT32);
 
+/*
+ * CPU_STAT_FLAT32
+ */
+#if defined(USE_FLAT32_TABLE)
+void AND_EdGd_flat32(void);
+void AND_GdEd_flat32(void);
+void OR_EdGd_flat32(void);
+void OR_GdEd_flat32(void);
+void XOR_EdGd_flat32(void);
+void XOR_GdEd_flat32(void);
+#endif
+
 //#ifdef __cplusplus
 //}
 //#endif
@@ -73,6 +73,22 @@ LEA_GdM(void)
 	EXCEPTION(UD_EXCEPTION, 0);
 }
 
+#if defined(USE_FLAT32_TABLE)
+void
+LEA_GdM_flat32(void)
+{
+	UINT32 op;
+
+	GET_PCBYTE(op);
+	if (op < 0xc0) {
+		CPU_WORKCLOCK(2);
+		*reg32_b53[op] = calc_ea32_dst(op);
+		return;
+	}
+	EXCEPTION(UD_EXCEPTION, 0);
+}
+#endif
+
 void
 _NOP(void)
 {
@@ -211,6 +227,7 @@ void
 OpSize(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_OP32 = !CPU_STATSAVE.cpu_inst_default.op_32;
 }
 
@@ -218,6 +235,7 @@ void
 AddrSize(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_AS32 = !CPU_STATSAVE.cpu_inst_default.as_32;
 }
 
@@ -358,6 +376,7 @@ void
 Prefix_ES(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_SEGUSE = 1;
 	CPU_INST_SEGREG_INDEX = CPU_ES_INDEX;
 }
@@ -366,6 +385,7 @@ void
 Prefix_CS(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_SEGUSE = 1;
 	CPU_INST_SEGREG_INDEX = CPU_CS_INDEX;
 }
@@ -374,6 +394,7 @@ void
 Prefix_SS(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_SEGUSE = 1;
 	CPU_INST_SEGREG_INDEX = CPU_SS_INDEX;
 }
@@ -382,6 +403,7 @@ void
 Prefix_DS(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_SEGUSE = 1;
 	CPU_INST_SEGREG_INDEX = CPU_DS_INDEX;
 }
@@ -390,6 +412,7 @@ void
 Prefix_FS(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_SEGUSE = 1;
 	CPU_INST_SEGREG_INDEX = CPU_FS_INDEX;
 }
@@ -398,6 +421,7 @@ void
 Prefix_GS(void)
 {
 
+	CPU_INST_PREFIXED();
 	CPU_INST_SEGUSE = 1;
 	CPU_INST_SEGREG_INDEX = CPU_GS_INDEX;
 }
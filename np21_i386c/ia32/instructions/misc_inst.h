@@ -32,6 +32,9 @@
 
 void LEA_GwM(void);
 void LEA_GdM(void);
+#if defined(USE_FLAT32_TABLE)
+void LEA_GdM_flat32(void);	/* CPU_STAT_FLAT32 */
+#endif
 void _NOP(void);
 void UD2(void);
 void XLAT(void);
@@ -154,10 +154,7 @@ static INLINE void SSE_PART_GETDATA1DATA2_P(float **data1, float **data2, float
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		*((UINT32*)(data2buf+ 0)) = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+ 0);
-		*((UINT32*)(data2buf+ 1)) = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+ 4);
-		*((UINT32*)(data2buf+ 2)) = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+ 8);
-		*((UINT32*)(data2buf+ 3)) = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+12);
+		*((XMM_REG*)(data2buf+ 0)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr+ 0);
 		*data2 = data2buf;
 	}
 }
@@ -682,10 +679,7 @@ void SSE_MOVAPSmem2xmm(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		data2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+ 0);
-		data2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+ 4);
-		data2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+ 8);
-		data2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr+12);
+		*((XMM_REG*)(data2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr+ 0);
 		data2 = data2buf.f32;
 	}
 	for(i=0;i<4;i++){
@@ -714,10 +708,7 @@ void SSE_MOVAPSxmm2mem(void)
 	} else {
 		UINT32 madr;
 		madr = calc_ea_dst(op);
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+ 0, *((UINT32*)(data1+ 0)));
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+ 4, *((UINT32*)(data1+ 1)));
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+ 8, *((UINT32*)(data1+ 2)));
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+12, *((UINT32*)(data1+ 3)));
+		cpu_vmemorywrite_dq(CPU_INST_SEGREG_INDEX, madr+ 0, (XMM_REG*)(data1+ 0));
 	}
 }
 void SSE_MOVHLPS(float *data1, float *data2)
@@ -1349,10 +1340,7 @@ void SSE_MOVNTPS(void)
 	} else {
 		UINT32 madr;
 		madr = calc_ea_dst(op);
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+ 0, *((UINT32*)(data1+ 0)));
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+ 4, *((UINT32*)(data1+ 1)));
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+ 8, *((UINT32*)(data1+ 2)));
-		cpu_vmemorywrite_d(CPU_INST_SEGREG_INDEX, madr+12, *((UINT32*)(data1+ 3)));
+		cpu_vmemorywrite_dq(CPU_INST_SEGREG_INDEX, madr+ 0, (XMM_REG*)(data1+ 0));
 	}
 }
 void SSE_MOVNTQ(void)
@@ -164,8 +164,7 @@ static INLINE void SSE_PART_GETDATA1DATA2_PD(double **data1, double **data2, dou
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		*((UINT64*)(data2buf+ 0)) = cpu_vmemoryread_q(CPU_INST_SEGREG_INDEX, maddr+ 0);
-		*((UINT64*)(data2buf+ 1)) = cpu_vmemoryread_q(CPU_INST_SEGREG_INDEX, maddr+ 8);
+		*((XMM_REG*)(data2buf+ 0)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr+ 0);
 		*data2 = data2buf;
 	}
 }
@@ -306,8 +305,7 @@ static INLINE void SSE_PART_GETDATA1DATA2_PD_XMM2MMX(SINT32 **data1, double **da
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		*((UINT64*)(data2buf+ 0)) = cpu_vmemoryread_q(CPU_INST_SEGREG_INDEX, maddr+ 0);
-		*((UINT64*)(data2buf+ 1)) = cpu_vmemoryread_q(CPU_INST_SEGREG_INDEX, maddr+ 8);
+		*((XMM_REG*)(data2buf+ 0)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr+ 0);
 		*data2 = data2buf;
 	}
 }
@@ -1215,10 +1213,7 @@ void SSE2_PACKSSDW(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		srcreg2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr);
-		srcreg2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 4);
-		srcreg2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 8);
-		srcreg2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 12);
+		*((XMM_REG*)(srcreg2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr);
 		srcreg1 = (INT32*)(&(FPU_STAT.xmm_reg[idx]));
 		srcreg2 = (INT32*)(srcreg2buf.d);
 		dstreg = (INT16*)(&(FPU_STAT.xmm_reg[idx]));
@@ -1270,10 +1265,7 @@ void SSE2_PACKSSWB(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		srcreg2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr);
-		srcreg2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 4);
-		srcreg2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 8);
-		srcreg2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 12);
+		*((XMM_REG*)(srcreg2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr);
 		srcreg1 = (INT16*)(&(FPU_STAT.xmm_reg[idx]));
 		srcreg2 = (INT16*)(srcreg2buf.w);
 		dstreg = (INT8*)(&(FPU_STAT.xmm_reg[idx]));
@@ -1325,10 +1317,7 @@ void SSE2_PACKUSWB(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		srcreg2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr);
-		srcreg2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 4);
-		srcreg2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 8);
-		srcreg2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 12);
+		*((XMM_REG*)(srcreg2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr);
 		srcreg1 = (INT16*)(&(FPU_STAT.xmm_reg[idx]));
 		srcreg2 = (INT16*)(srcreg2buf.w);
 		dstreg = (UINT8*)(&(FPU_STAT.xmm_reg[idx]));
@@ -1806,10 +1795,7 @@ void SSE2_PMULHUW(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		data2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr);
-		data2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 4);
-		data2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 8);
-		data2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 12);
+		*((XMM_REG*)(data2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr);
 		data2 = data2buf.w;
 	}
 	for(i=0;i<8;i++){
@@ -1837,10 +1823,7 @@ void SSE2_PMULHW(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		data2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr);
-		data2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 4);
-		data2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 8);
-		data2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 12);
+		*((XMM_REG*)(data2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr);
 		data2 = (SINT16*)(data2buf.w);
 	}
 	for(i=0;i<8;i++){
@@ -1868,10 +1851,7 @@ void SSE2_PMULLW(void)
 	} else {
 		UINT32 maddr;
 		maddr = calc_ea_dst((op));
-		data2buf.d[0] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr);
-		data2buf.d[1] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 4);
-		data2buf.d[2] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 8);
-		data2buf.d[3] = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, maddr + 12);
+		*((XMM_REG*)(data2buf.d)) = cpu_vmemoryread_dq(CPU_INST_SEGREG_INDEX, maddr);
 		data2 = (SINT16*)(data2buf.w);
 	}
 	for(i=0;i<8;i++){
@@ -33,6 +33,348 @@
 #include "misc_inst.h"
 #endif
 
+#if defined(USE_REP_BULK)
+/*
+ * REP MOVS/STOS and REPE/REPNE CMPS/SCAS in bulk
+ *
+ * With 32bit addressing and flat segments the elements up to the next
+ * page boundary of ESI/EDI are handled as one block: memmove()/memset()/
+ * memcmp()/memchr() on the guest memory in flat memory mode without
+ * paging, otherwise a block read/write through rep_bulk_buf.  A chunk never leaves the page
+ * of either string, so a fault hits its first element as in the
+ * element loop, with ESI/EDI/ECX still pointing at it.  A MOVS chunk
+ * also ends before the source bytes its destination overwrites (the
+ * element loop would copy those again), and no chunk runs more elements
+ * than the loop would before CPU_REMCLOCK runs out.
+ *
+ * Without flat memory or the block callback (or with A20 masked) a
+ * block access turns into byte accesses on the bus, so the element
+ * loop is kept there.
+ */
+static UINT8 rep_bulk_buf[2][CPU_PAGE_SIZE];
+
+STATIC_INLINE BOOL
+rep_bulk_usable(int idx)
+{
+
+	return (cpumemflat || ((i386memblock != NULL) && (CPU_ADRSMASK == ~(UINT32)0)))
+	    && SEG_IS_FLAT(&CPU_STAT_SREG(CPU_ES_INDEX))
+	    && ((idx < 0) || SEG_IS_FLAT(&CPU_STAT_SREG(idx)));
+}
+
+/* elements from addr on that are inside its page */
+STATIC_INLINE UINT32
+rep_bulk_page(UINT32 n, UINT32 addr, UINT size, BOOL down)
+{
+	UINT32 off = addr & CPU_PAGE_MASK;
+	UINT32 m;
+
+	if (off > CPU_PAGE_SIZE - size)
+		return 0;
+	m = (!down) ? (CPU_PAGE_SIZE - off) / size : off / size + 1;
+	return (m < n) ? m : n;
+}
+
+/* elements the element loop runs before CPU_REMCLOCK runs out */
+STATIC_INLINE UINT32
+rep_bulk_clock(UINT32 n, int clock)
+{
+#if !defined(USE_CLOCKLESS)
+	UINT32 m;
+
+	if (CPU_REMCLOCK <= 0)
+		return 1;
+	m = ((UINT32)CPU_REMCLOCK + (clock - 1)) / clock;
+	return (m < n) ? m : n;
+#else
+	/* CPU_REMCLOCK does not run out, a stop request ends the loop */
+	(void)clock;
+	return (CPU_REMCLOCK > 0) ? n : 1;
+#endif
+}
+
+/* REP MOVS, 32bit address.  FALSE: not done, use the element loop */
+static BOOL
+rep_movs_bulk(UINT size, int clock)
+{
+	UINT8 *sp, *dp;
+	UINT32 src, dst, dist;
+	UINT32 n;
+	UINT len;
+	BOOL down;
+	int idx = CPU_INST_SEGREG_INDEX;
+
+	if (!rep_bulk_usable(idx))
+		return FALSE;
+
+	down = (CPU_FLAG & D_FLAG) != 0;
+	for (;;) {
+		n = rep_bulk_clock(CPU_ECX, clock);
+		n = rep_bulk_page(n, CPU_ESI, size, down);
+		n = rep_bulk_page(n, CPU_EDI, size, down);
+		dist = (!down) ? CPU_EDI - CPU_ESI : CPU_ESI - CPU_EDI;
+		if ((dist != 0) && (dist / size < n))
+			n = dist / size;
+		if (n == 0)
+			n = 1;	/* crosses a page, or overlaps its source */
+
+		len = n * size;
+		src = (!down) ? CPU_ESI : CPU_ESI - (len - size);
+		dst = (!down) ? CPU_EDI : CPU_EDI - (len - size);
+		sp = cpu_vmemory_hostptr(idx, src, len, CPU_PAGE_READ_DATA);
+		dp = (sp != NULL) ? cpu_vmemory_hostptr(CPU_ES_INDEX, dst, len, CPU_PAGE_WRITE_DATA) : NULL;
+		if (dp != NULL) {
+			memmove(dp, sp, len);
+		} else {
+			cpu_vmemoryread_block(idx, src, rep_bulk_buf[0], len);
+			cpu_vmemorywrite_block(CPU_ES_INDEX, dst, rep_bulk_buf[0], len);
+		}
+
+		CPU_WORKCLOCK(clock * n);
+		if (!down) {
+			CPU_ESI += len;
+			CPU_EDI += len;
+		} else {
+			CPU_ESI -= len;
+			CPU_EDI -= len;
+		}
+		if ((CPU_ECX -= n) == 0) {
+#if defined(DEBUG)
+			cpu_debug_rep_cont = 0;
+#endif
+			break;
+		}
+		if (CPU_REMCLOCK <= 0) {
+			CPU_EIP = CPU_PREV_EIP;
+			break;
+		}
+	}
+	return TRUE;
+}
+
+/* REP STOS, 32bit address.  FALSE: not done, use the element loop */
+static BOOL
+rep_stos_bulk(UINT size, UINT32 value, int clock)
+{
+	UINT8 *dp, *p;
+	UINT32 dst;
+	UINT32 n;
+	UINT len, i;
+	BOOL down;
+
+	if (!rep_bulk_usable(-1))
+		return FALSE;
+
+	down = (CPU_FLAG & D_FLAG) != 0;
+	for (;;) {
+		n = rep_bulk_clock(CPU_ECX, clock);
+		n = rep_bulk_page(n, CPU_EDI, size, down);
+		if (n == 0)
+			n = 1;	/* crosses a page */
+
+		len = n * size;
+		dst = (!down) ? CPU_EDI : CPU_EDI - (len - size);
+		dp = cpu_vmemory_hostptr(CPU_ES_INDEX, dst, len, CPU_PAGE_WRITE_DATA);
+		p = (dp != NULL) ? dp : rep_bulk_buf[0];
+		if (size == 1) {
+			memset(p, (UINT8)value, len);
+		} else if (size == 2) {
+			for (i = 0; i < len; i += 2) {
+				STOREINTELWORD(p + i, value);
+			}
+		} else {
+			for (i = 0; i < len; i += 4) {
+				STOREINTELDWORD(p + i, value);
+			}
+		}
+		if (dp == NULL) {
+			cpu_vmemorywrite_block(CPU_ES_INDEX, dst, rep_bulk_buf[0], len);
+		}
+
+		CPU_WORKCLOCK(clock * n);
+		if (!down) {
+			CPU_EDI += len;
+		} else {
+			CPU_EDI -= len;
+		}
+		if ((CPU_ECX -= n) == 0) {
+#if defined(DEBUG)
+			cpu_debug_rep_cont = 0;
+#endif
+			break;
+		}
+		if (CPU_REMCLOCK <= 0) {
+			CPU_EIP = CPU_PREV_EIP;
+			break;
+		}
+	}
+	return TRUE;
+}
+
+/* element i of a chunk at p (the chunk starts at its lowest address) */
+STATIC_INLINE UINT32
+rep_bulk_elem(const UINT8 *p, UINT32 i, UINT len, UINT size, BOOL down)
+{
+
+	p += (!down) ? i * size : len - size - i * size;
+	if (size == 1)
+		return p[0];
+	if (size == 2)
+		return LOADINTELWORD(p);
+	return LOADINTELDWORD(p);
+}
+
+STATIC_INLINE const UINT8 *
+rep_bulk_read(int idx, UINT32 addr, UINT len, UINT8 *buf)
+{
+	UINT8 *p;
+
+	p = cpu_vmemory_hostptr(idx, addr, len, CPU_PAGE_READ_DATA);
+	if (p == NULL) {
+		cpu_vmemoryread_block(idx, addr, buf, len);
+		p = buf;
+	}
+	return p;
+}
+
+STATIC_INLINE void
+rep_bulk_sub(UINT size, UINT32 dst, UINT32 src)
+{
+
+	if (size == 1) {
+		BYTE_CMP(dst, src);
+	} else if (size == 2) {
+		WORD_CMP(dst, src);
+	} else {
+		DWORD_CMP(dst, src);
+	}
+}
+
+/*
+ * REPE/REPNE CMPS, 32bit address.  FALSE: not done, use the element loop
+ *
+ * Each chunk is read whole and searched for the element that ends the
+ * string; the flags come from the last element compared only.
+ */
+static BOOL
+rep_cmps_bulk(UINT size, int reptype)
+{
+	const UINT8 *sp, *dp;
+	UINT32 src, dst;
+	UINT32 n, i;
+	UINT len;
+	BOOL down;
+	BOOL stopeq = (reptype == 2);
+	int idx = CPU_INST_SEGREG_INDEX;
+
+	if ((reptype == 0) || !rep_bulk_usable(idx))
+		return FALSE;
+
+	down = (CPU_FLAG & D_FLAG) != 0;
+	for (;;) {
+		n = rep_bulk_clock(CPU_ECX, 8);
+		n = rep_bulk_page(n, CPU_ESI, size, down);
+		n = rep_bulk_page(n, CPU_EDI, size, down);
+		if (n == 0)
+			n = 1;	/* crosses a page */
+
+		len = n * size;
+		src = (!down) ? CPU_ESI : CPU_ESI - (len - size);
+		dst = (!down) ? CPU_EDI : CPU_EDI - (len - size);
+		sp = rep_bulk_read(idx, src, len, rep_bulk_buf[0]);
+		dp = rep_bulk_read(CPU_ES_INDEX, dst, len, rep_bulk_buf[1]);
+
+		if ((size == 1) && !down && !stopeq && (memcmp(sp, dp, len) == 0)) {
+			i = n - 1;
+		} else {
+			for (i = 0; i < n - 1; i++) {
+				if ((rep_bulk_elem(sp, i, len, size, down) == rep_bulk_elem(dp, i, len, size, down)) == stopeq)
+					break;
+			}
+		}
+		rep_bulk_sub(size, rep_bulk_elem(sp, i, len, size, down), rep_bulk_elem(dp, i, len, size, down));
+
+		n = i + 1;
+		CPU_WORKCLOCK(8 * n);
+		if (!down) {
+			CPU_ESI += n * size;
+			CPU_EDI += n * size;
+		} else {
+			CPU_ESI -= n * size;
+			CPU_EDI -= n * size;
+		}
+		if (((CPU_ECX -= n) == 0) || (stopeq ? CC_Z : CC_NZ)) {
+#if defined(DEBUG)
+			cpu_debug_rep_cont = 0;
+#endif
+			break;
+		}
+		if (CPU_REMCLOCK <= 0) {
+			CPU_EIP = CPU_PREV_EIP;
+			break;
+		}
+	}
+	return TRUE;
+}
+
+/* REPE/REPNE SCAS, 32bit address.  FALSE: not done, use the element loop */
+static BOOL
+rep_scas_bulk(UINT size, UINT32 value, int reptype)
+{
+	const UINT8 *dp, *p;
+	UINT32 dst;
+	UINT32 n, i;
+	UINT len;
+	BOOL down;
+	BOOL stopeq = (reptype == 2);
+
+	if ((reptype == 0) || !rep_bulk_usable(-1))
+		return FALSE;
+
+	down = (CPU_FLAG & D_FLAG) != 0;
+	for (;;) {
+		n = rep_bulk_clock(CPU_ECX, 7);
+		n = rep_bulk_page(n, CPU_EDI, size, down);
+		if (n == 0)
+			n = 1;	/* crosses a page */
+
+		len = n * size;
+		dst = (!down) ? CPU_EDI : CPU_EDI - (len - size);
+		dp = rep_bulk_read(CPU_ES_INDEX, dst, len, rep_bulk_buf[0]);
+
+		if ((size == 1) && !down && stopeq) {
+			p = (const UINT8 *)memchr(dp, (UINT8)value, len - 1);
+			i = (p != NULL) ? (UINT32)(p - dp) : n - 1;
+		} else {
+			for (i = 0; i < n - 1; i++) {
+				if ((rep_bulk_elem(dp, i, len, size, down) == value) == stopeq)
+					break;
+			}
+		}
+		rep_bulk_sub(size, value, rep_bulk_elem(dp, i, len, size, down));
+
+		n = i + 1;
+		CPU_WORKCLOCK(7 * n);
+		if (!down) {
+			CPU_EDI += n * size;
+		} else {
+			CPU_EDI -= n * size;
+		}
+		if (((CPU_ECX -= n) == 0) || (stopeq ? CC_Z : CC_NZ)) {
+#if defined(DEBUG)
+			cpu_debug_rep_cont = 0;
+#endif
+			break;
+		}
+		if (CPU_REMCLOCK <= 0) {
+			CPU_EIP = CPU_PREV_EIP;
+			break;
+		}
+	}
+	return TRUE;
+}
+#endif
+
 
 /* movs */
 void
@@ -206,6 +548,10 @@ MOVSB_XbYb_rep(int reptype)
 	}else{
 		switch(reptype){
 		case 0: /* rep */
+#if defined(USE_REP_BULK)
+			if (rep_movs_bulk(1, 5))
+				break;
+#endif
 			for (;;) {
 				MOVSB_XbYb_rep32_part;
 				if (--CPU_ECX == 0) {
@@ -311,6 +657,10 @@ MOVSW_XwYw_rep(int reptype)
 	}else{
 		switch(reptype){
 		case 0: /* rep */
+#if defined(USE_REP_BULK)
+			if (rep_movs_bulk(2, 5))
+				break;
+#endif
 			for (;;) {
 				MOVSW_XwYw_rep32_part;
 				if (--CPU_ECX == 0) {
@@ -416,6 +766,10 @@ MOVSD_XdYd_rep(int reptype)
 	}else{
 		switch(reptype){
 		case 0: /* rep */
+#if defined(USE_REP_BULK)
+			if (rep_movs_bulk(4, 5))
+				break;
+#endif
 			for (;;) {
 				MOVSD_XdYd_rep32_part;
 				if (--CPU_ECX == 0) {
@@ -469,20 +823,20 @@ MOVSD_XdYd_rep(int reptype)
 void
 CMPSB_XbYb(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(8);
 	CPU_INST_SEGREG_INDEX = DS_FIX;
 	if (!CPU_INST_AS32) {
 		dst = cpu_vmemoryread(CPU_INST_SEGREG_INDEX, CPU_SI);
 		src = cpu_vmemoryread(CPU_ES_INDEX, CPU_DI);
-		BYTE_SUB(res, dst, src);
+		BYTE_CMP(dst, src);
 		CPU_SI += STRING_DIR;
 		CPU_DI += STRING_DIR;
 	} else {
 		dst = cpu_vmemoryread(CPU_INST_SEGREG_INDEX, CPU_ESI);
 		src = cpu_vmemoryread(CPU_ES_INDEX, CPU_EDI);
-		BYTE_SUB(res, dst, src);
+		BYTE_CMP(dst, src);
 		CPU_ESI += STRING_DIR;
 		CPU_EDI += STRING_DIR;
 	}
@@ -491,20 +845,20 @@ CMPSB_XbYb(void)
 void
 CMPSW_XwYw(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(8);
 	CPU_INST_SEGREG_INDEX = DS_FIX;
 	if (!CPU_INST_AS32) {
 		dst = cpu_vmemoryread_w(CPU_INST_SEGREG_INDEX, CPU_SI);
 		src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_DI);
-		WORD_SUB(res, dst, src);
+		WORD_CMP(dst, src);
 		CPU_SI += STRING_DIRx2;
 		CPU_DI += STRING_DIRx2;
 	} else {
 		dst = cpu_vmemoryread_w(CPU_INST_SEGREG_INDEX, CPU_ESI);
 		src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_EDI);
-		WORD_SUB(res, dst, src);
+		WORD_CMP(dst, src);
 		CPU_ESI += STRING_DIRx2;
 		CPU_EDI += STRING_DIRx2;
 	}
@@ -513,20 +867,20 @@ CMPSW_XwYw(void)
 void
 CMPSD_XdYd(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(8);
 	CPU_INST_SEGREG_INDEX = DS_FIX;
 	if (!CPU_INST_AS32) {
 		dst = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, CPU_SI);
 		src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_DI);
-		DWORD_SUB(res, dst, src);
+		DWORD_CMP(dst, src);
 		CPU_SI += STRING_DIRx4;
 		CPU_DI += STRING_DIRx4;
 	} else {
 		dst = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, CPU_ESI);
 		src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_EDI);
-		DWORD_SUB(res, dst, src);
+		DWORD_CMP(dst, src);
 		CPU_ESI += STRING_DIRx4;
 		CPU_EDI += STRING_DIRx4;
 	}
@@ -537,7 +891,7 @@ CMPSD_XdYd(void)
 		CPU_WORKCLOCK(8);\
 		dst = cpu_vmemoryread(CPU_INST_SEGREG_INDEX, CPU_SI);\
 		src = cpu_vmemoryread(CPU_ES_INDEX, CPU_DI);\
-		BYTE_SUB(res, dst, src);\
+		BYTE_CMP(dst, src);\
 		CPU_SI += STRING_DIR;\
 		CPU_DI += STRING_DIR;\
   } while (0)
@@ -547,7 +901,7 @@ CMPSD_XdYd(void)
 		CPU_WORKCLOCK(8);\
 		dst = cpu_vmemoryread_w(CPU_INST_SEGREG_INDEX, CPU_SI);\
 		src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_DI);\
-		WORD_SUB(res, dst, src);\
+		WORD_CMP(dst, src);\
 		CPU_SI += STRING_DIRx2;\
 		CPU_DI += STRING_DIRx2;\
   } while (0)
@@ -557,7 +911,7 @@ CMPSD_XdYd(void)
 		CPU_WORKCLOCK(8);\
 		dst = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, CPU_SI);\
 		src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_DI);\
-		DWORD_SUB(res, dst, src);\
+		DWORD_CMP(dst, src);\
 		CPU_SI += STRING_DIRx4;\
 		CPU_DI += STRING_DIRx4;\
   } while (0)
@@ -567,7 +921,7 @@ CMPSD_XdYd(void)
 		CPU_WORKCLOCK(8);\
 		dst = cpu_vmemoryread(CPU_INST_SEGREG_INDEX, CPU_ESI);\
 		src = cpu_vmemoryread(CPU_ES_INDEX, CPU_EDI);\
-		BYTE_SUB(res, dst, src);\
+		BYTE_CMP(dst, src);\
 		CPU_ESI += STRING_DIR;\
 		CPU_EDI += STRING_DIR;\
   } while (0)
@@ -577,7 +931,7 @@ CMPSD_XdYd(void)
 		CPU_WORKCLOCK(8);\
 		dst = cpu_vmemoryread_w(CPU_INST_SEGREG_INDEX, CPU_ESI);\
 		src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_EDI);\
-		WORD_SUB(res, dst, src);\
+		WORD_CMP(dst, src);\
 		CPU_ESI += STRING_DIRx2;\
 		CPU_EDI += STRING_DIRx2;\
   } while (0)
@@ -587,14 +941,14 @@ CMPSD_XdYd(void)
 		CPU_WORKCLOCK(8);\
 		dst = cpu_vmemoryread_d(CPU_INST_SEGREG_INDEX, CPU_ESI);\
 		src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_EDI);\
-		DWORD_SUB(res, dst, src);\
+		DWORD_CMP(dst, src);\
 		CPU_ESI += STRING_DIRx4;\
 		CPU_EDI += STRING_DIRx4;\
   } while (0)
 void
 CMPSB_XbYb_rep(int reptype)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 	
 	CPU_INST_SEGREG_INDEX = DS_FIX;
 	if (!CPU_INST_AS32) {
@@ -646,6 +1000,10 @@ CMPSB_XbYb_rep(int reptype)
 			break;
 		}
 	}else{
+#if defined(USE_REP_BULK)
+		if (rep_cmps_bulk(1, reptype))
+			return;
+#endif
 		switch(reptype){
 		case 0: /* rep */
 			for (;;) {
@@ -699,7 +1057,7 @@ CMPSB_XbYb_rep(int reptype)
 void
 CMPSW_XwYw_rep(int reptype)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 	
 	CPU_INST_SEGREG_INDEX = DS_FIX;
 	if (!CPU_INST_AS32) {
@@ -751,6 +1109,10 @@ CMPSW_XwYw_rep(int reptype)
 			break;
 		}
 	}else{
+#if defined(USE_REP_BULK)
+		if (rep_cmps_bulk(2, reptype))
+			return;
+#endif
 		switch(reptype){
 		case 0: /* rep */
 			for (;;) {
@@ -804,7 +1166,7 @@ CMPSW_XwYw_rep(int reptype)
 void
 CMPSD_XdYd_rep(int reptype)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 	
 	CPU_INST_SEGREG_INDEX = DS_FIX;
 	if (!CPU_INST_AS32) {
@@ -856,6 +1218,10 @@ CMPSD_XdYd_rep(int reptype)
 			break;
 		}
 	}else{
+#if defined(USE_REP_BULK)
+		if (rep_cmps_bulk(4, reptype))
+			return;
+#endif
 		switch(reptype){
 		case 0: /* rep */
 			for (;;) {
@@ -911,17 +1277,17 @@ CMPSD_XdYd_rep(int reptype)
 void
 SCASB_ALXb(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(7);
 	dst = CPU_AL;
 	if (!CPU_INST_AS32) {
 		src = cpu_vmemoryread(CPU_ES_INDEX, CPU_DI);
-		BYTE_SUB(res, dst, src);
+		BYTE_CMP(dst, src);
 		CPU_DI += STRING_DIR;
 	} else {
 		src = cpu_vmemoryread(CPU_ES_INDEX, CPU_EDI);
-		BYTE_SUB(res, dst, src);
+		BYTE_CMP(dst, src);
 		CPU_EDI += STRING_DIR;
 	}
 }
@@ -929,17 +1295,17 @@ SCASB_ALXb(void)
 void
 SCASW_AXXw(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(7);
 	dst = CPU_AX;
 	if (!CPU_INST_AS32) {
 		src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_DI);
-		WORD_SUB(res, dst, src);
+		WORD_CMP(dst, src);
 		CPU_DI += STRING_DIRx2;
 	} else {
 		src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_EDI);
-		WORD_SUB(res, dst, src);
+		WORD_CMP(dst, src);
 		CPU_EDI += STRING_DIRx2;
 	}
 }
@@ -947,21 +1313,165 @@ SCASW_AXXw(void)
 void
 SCASD_EAXXd(void)
 {
-	UINT32 src, dst, res;
+	UINT32 src, dst;
 
 	CPU_WORKCLOCK(7);
 	dst = CPU_EAX;
 	if (!CPU_INST_AS32) {
 		src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_DI);
-		DWORD_SUB(res, dst, src);
+		DWORD_CMP(dst, src);
 		CPU_DI += STRING_DIRx4;
 	} else {
 		src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_EDI);
-		DWORD_SUB(res, dst, src);
+		DWORD_CMP(dst, src);
 		CPU_EDI += STRING_DIRx4;
 	}
 }
 
+/* repe: stop on ZF=0, repne: stop on ZF=1 */
+#define	SCAS_REP_STOP(t)	(((t) == 1) ? CC_NZ : (((t) == 2) ? CC_Z : 0))
+
+void
+SCASB_ALXb_rep(int reptype)
+{
+	UINT32 src, dst;
+
+	dst = CPU_AL;
+	if (!CPU_INST_AS32) {
+		for (;;) {
+			CPU_WORKCLOCK(7);
+			src = cpu_vmemoryread(CPU_ES_INDEX, CPU_DI);
+			BYTE_CMP(dst, src);
+			CPU_DI += STRING_DIR;
+			if (--CPU_CX == 0 || SCAS_REP_STOP(reptype)) {
+#if defined(DEBUG)
+				cpu_debug_rep_cont = 0;
+#endif
+				break;
+			}
+			if (CPU_REMCLOCK <= 0) {
+				CPU_EIP = CPU_PREV_EIP;
+				break;
+			}
+		}
+	} else {
+#if defined(USE_REP_BULK)
+		if (rep_scas_bulk(1, dst, reptype))
+			return;
+#endif
+		for (;;) {
+			CPU_WORKCLOCK(7);
+			src = cpu_vmemoryread(CPU_ES_INDEX, CPU_EDI);
+			BYTE_CMP(dst, src);
+			CPU_EDI += STRING_DIR;
+			if (--CPU_ECX == 0 || SCAS_REP_STOP(reptype)) {
+#if defined(DEBUG)
+				cpu_debug_rep_cont = 0;
+#endif
+				break;
+			}
+			if (CPU_REMCLOCK <= 0) {
+				CPU_EIP = CPU_PREV_EIP;
+				break;
+			}
+		}
+	}
+}
+
+void
+SCASW_AXXw_rep(int reptype)
+{
+	UINT32 src, dst;
+
+	dst = CPU_AX;
+	if (!CPU_INST_AS32) {
+		for (;;) {
+			CPU_WORKCLOCK(7);
+			src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_DI);
+			WORD_CMP(dst, src);
+			CPU_DI += STRING_DIRx2;
+			if (--CPU_CX == 0 || SCAS_REP_STOP(reptype)) {
+#if defined(DEBUG)
+				cpu_debug_rep_cont = 0;
+#endif
+				break;
+			}
+			if (CPU_REMCLOCK <= 0) {
+				CPU_EIP = CPU_PREV_EIP;
+				break;
+			}
+		}
+	} else {
+#if defined(USE_REP_BULK)
+		if (rep_scas_bulk(2, dst, reptype))
+			return;
+#endif
+		for (;;) {
+			CPU_WORKCLOCK(7);
+			src = cpu_vmemoryread_w(CPU_ES_INDEX, CPU_EDI);
+			WORD_CMP(dst, src);
+			CPU_EDI += STRING_DIRx2;
+			if (--CPU_ECX == 0 || SCAS_REP_STOP(reptype)) {
+#if defined(DEBUG)
+				cpu_debug_rep_cont = 0;
+#endif
+				break;
+			}
+			if (CPU_REMCLOCK <= 0) {
+				CPU_EIP = CPU_PREV_EIP;
+				break;
+			}
+		}
+	}
+}
+
+void
+SCASD_EAXXd_rep(int reptype)
+{
+	UINT32 src, dst;
+
+	dst = CPU_EAX;
+	if (!CPU_INST_AS32) {
+		for (;;) {
+			CPU_WORKCLOCK(7);
+			src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_DI);
+			DWORD_CMP(dst, src);
+			CPU_DI += STRING_DIRx4;
+			if (--CPU_CX == 0 || SCAS_REP_STOP(reptype)) {
+#if defined(DEBUG)
+				cpu_debug_rep_cont = 0;
+#endif
+				break;
+			}
+			if (CPU_REMCLOCK <= 0) {
+				CPU_EIP = CPU_PREV_EIP;
+				break;
+			}
+		}
+	} else {
+#if defined(USE_REP_BULK)
+		if (rep_scas_bulk(4, dst, reptype))
+			return;
+#endif
+		for (;;) {
+			CPU_WORKCLOCK(7);
+			src = cpu_vmemoryread_d(CPU_ES_INDEX, CPU_EDI);
+			DWORD_CMP(dst, src);
+			CPU_EDI += STRING_DIRx4;
+			if (--CPU_ECX == 0 || SCAS_REP_STOP(reptype)) {
+#if defined(DEBUG)
+				cpu_debug_rep_cont = 0;
+#endif
+				break;
+			}
+			if (CPU_REMCLOCK <= 0) {
+				CPU_EIP = CPU_PREV_EIP;
+				break;
+			}
+		}
+	}
+}
+
 
 /* lods */
 void
@@ -1074,6 +1584,10 @@ STOSB_YbAL_rep(int reptype)
 			}
 		}
 	} else {
+#if defined(USE_REP_BULK)
+		if (rep_stos_bulk(1, CPU_AL, 3))
+			return;
+#endif
 		for (;;) {
 			CPU_WORKCLOCK(3);
 			cpu_vmemorywrite(CPU_ES_INDEX, CPU_EDI, CPU_AL);
@@ -1113,6 +1627,10 @@ STOSW_YwAX_rep(int reptype)
 			}
 		}
 	} else {
+#if defined(USE_REP_BULK)
+		if (rep_stos_bulk(2, CPU_AX, 3))
+			return;
+#endif
 		for (;;) {
 			CPU_WORKCLOCK(3);
 			cpu_vmemorywrite_w(CPU_ES_INDEX, CPU_EDI, CPU_AX);
@@ -1152,6 +1670,10 @@ STOSD_YdEAX_rep(int reptype)
 			}
 		}
 	} else {
+#if defined(USE_REP_BULK)
+		if (rep_stos_bulk(4, CPU_EAX, 3))
+			return;
+#endif
 		for (;;) {
 			CPU_WORKCLOCK(3);
 			cpu_vmemorywrite_d(CPU_ES_INDEX, CPU_EDI, CPU_EAX);
@@ -1175,12 +1697,14 @@ STOSD_YdEAX_rep(int reptype)
 void
 _REPNE(void)
 {
+	CPU_INST_PREFIXED();
 	CPU_INST_REPUSE = 0xf2;
 }
 
 void
 _REPE(void)
 {
+	CPU_INST_PREFIXED();
 	CPU_INST_REPUSE = 0xf3;
 }
 
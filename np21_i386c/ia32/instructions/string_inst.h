@@ -54,6 +54,9 @@ void CMPSD_XdYd_rep(int reptype);
 void SCASB_ALXb(void);
 void SCASW_AXXw(void);
 void SCASD_EAXXd(void);
+void SCASB_ALXb_rep(int reptype);
+void SCASW_AXXw_rep(int reptype);
+void SCASD_EAXXd_rep(int reptype);
 
 /* lods */
 void LODSB_ALXb(void);
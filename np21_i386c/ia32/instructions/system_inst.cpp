@@ -306,7 +306,7 @@ MOV_CdRd(void)
 			CPU_CR0 = src;
 			VERBOSE(("MOV_CdRd: %04x:%08x: cr0: 0x%08x <- 0x%08x(%s)", CPU_CS, CPU_PREV_EIP, reg, CPU_CR0, reg32_str[op & 7]));
 
-			if ((reg ^ CPU_CR0) & (CPU_CR0_PE|CPU_CR0_PG)) {
+			if ((reg ^ CPU_CR0) & (CPU_CR0_PE|CPU_CR0_PG|CPU_CR0_WP)) {
 				tlb_flush_all();
 			}
 			if ((reg ^ CPU_CR0) & CPU_CR0_PE) {
@@ -375,6 +375,7 @@ MOV_CdRd(void)
 			    | CPU_CR4_OSXMMEXCPT
 #endif
 			    | CPU_CR4_PCE
+			    | CPU_CR4_PSE	/* paging() handles 4MB pages */
 			;
 			if (src & ~reg) {
 				//if (src & 0xfffffc00) {
@@ -1161,6 +1162,19 @@ RDTSC(void)
 	}
 	CPU_EDX = li.HighPart;
 	CPU_EAX = li.LowPart;
+#elif defined(USE_CLOCKLESS)
+	/* no clock is counted, so the host time stands in for it */
+	static LARGE_INTEGER qpf = {0};
+	UINT64 tsc_tmp;
+	LARGE_INTEGER li = {0};
+	if (qpf.QuadPart == 0) {
+		QueryPerformanceFrequency(&qpf);	/* fixed at boot */
+	}
+	QueryPerformanceCounter(&li);
+	tsc_tmp = (UINT64)(li.QuadPart / qpf.QuadPart) * CPU_REALCLOCK
+	    + (UINT64)(li.QuadPart % qpf.QuadPart) * CPU_REALCLOCK / qpf.QuadPart;
+	CPU_EDX = ((tsc_tmp >> 32) & 0xffffffff);
+	CPU_EAX = (tsc_tmp & 0xffffffff);
 #else
 	if(/*np2cfg.consttsc*/0){
 		// CPUNbNɈˑȂJE^lɂ
@@ -1251,6 +1265,7 @@ SYSENTER(void)
 
 	CPU_STAT_CPL = 0;
 	CPU_STAT_USER_MODE = (CPU_STAT_CPL == 3) ? CPU_MODE_USER : CPU_MODE_SUPERVISER;
+	CPU_CLEARPREFETCH();
 }
 
 // r[m[`FbN
@@ -1284,4 +1299,5 @@ SYSEXIT(void)
 
 	CPU_STAT_CPL = 3;
 	CPU_STAT_USER_MODE = (CPU_STAT_CPL == 3) ? CPU_MODE_USER : CPU_MODE_SUPERVISER;
+	CPU_CLEARPREFETCH();
 }
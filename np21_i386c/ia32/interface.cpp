@@ -26,6 +26,7 @@
 //#include "compiler.h"
 #include "cpu.h"
 #include "ia32.mcr"
+#include "inst_table.h"
 
 //#include "pccore.h"
 //#include "iocore.h"
@@ -45,6 +46,8 @@ ia32_initreg(void)
 	int i;
 
 	CPU_STATSAVE.cpu_inst_default.seg_base = (UINT32)-1;
+	CPU_INST_PREFIXED();	/* pick up the new defaults */
+	CPU_LAZYFLAGS_CLEAR();	/* the flags were just zeroed */
 
 	CPU_EDX = (CPU_FAMILY << 8) | (CPU_MODEL << 4) | CPU_STEPPING;
 	CPU_EFLAG = 2;
@@ -89,6 +92,9 @@ ia32_initreg(void)
 
 	tlb_init();
 	fpu_initialize();
+#if defined(USE_FLAT32_TABLE)
+	insttable_flat32_init();
+#endif
 }
 
 void
@@ -113,6 +119,7 @@ ia32a20enable(BOOL enable)
 
 //	CPU_ADRSMASK = (enable)?0xffffffff:0x00ffffff;
 	CPU_ADRSMASK = (enable)?(~0):(~(1 << 20));
+	CPU_CLEARPREFETCH();
 }
 
 //#pragma optimize("", off)
@@ -139,6 +146,8 @@ ia32(void)
 		break;
 	}
 #endif
+	codecache_flush();
+	CPU_CLEARPREFETCH();	/* the host may have changed guest memory and state */
 /*
 	if (!CPU_TRAP && !dmac.working) {
 		exec_allstep();
@@ -204,6 +213,8 @@ ia32_step(void)
 		break;
 	}
 #endif
+	codecache_flush();
+	CPU_CLEARPREFETCH();	/* the host may have changed guest memory and state */
 	do {
 		exec_1step();
 		if (CPU_TRAP) {
@@ -292,6 +303,11 @@ ia32_panic(const char *str, ...)
 #if defined(IA32_REBOOT_ON_PANIC)
 	VERBOSE(("ia32_panic: reboot"));
 	//kbd_reset();
+#if defined(USE_EXCEPTION_LONGJMP)
+	if (exec_recover != NULL) {
+		longjmp(*exec_recover, 2);
+	}
+#endif
 #ifdef __cplusplus
 	throw(2);
 #else
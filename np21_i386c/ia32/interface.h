@@ -51,7 +51,7 @@
 #define CPU_INITIALIZE()		i386c_initialize()
 #define	CPU_DEINITIALIZE()
 //#define	CPU_RESET()			ia32reset()
-#define	CPU_CLEARPREFETCH()
+#define	CPU_CLEARPREFETCH()		(codefetch_window.len = 0, CPU_STAT_FLAT32 = FLAT32_RECHECK)
 #define	CPU_INTERRUPT(vect, soft)	ia32_interrupt(vect, soft)
 #define	CPU_EXEC()			ia32()
 #define	CPU_EXECV30()			ia32()
@@ -59,18 +59,19 @@
 //#define	CPU_SETEXTSIZE(size)		ia32_setextsize((UINT32)(size) << 20)
 //#define CPU_SETEMM(frame, addr)		ia32_setemm(frame, addr)
 
-#define	cpu_memorywrite(a,v)	memp_write8(a,v)
-#define	cpu_memorywrite_b(a,v)	memp_write8(a,v)
-#define	cpu_memorywrite_w(a,v)	memp_write16(a,v)
-#define	cpu_memorywrite_d(a,v)	memp_write32(a,v)
-#define	cpu_memoryread(a)	memp_read8(a)
-#define	cpu_memoryread_b(a)	memp_read8(a)
-#define	cpu_memoryread_w(a)	memp_read16(a)
-#define	cpu_memoryread_d(a)	memp_read32(a)
-#define	cpu_memoryread_codefetch(a)		memp_read8_codefetch(a)
-#define	cpu_memoryread_b_codefetch(a)	memp_read8_codefetch(a)
-#define	cpu_memoryread_w_codefetch(a)	memp_read16_codefetch(a)
-#define	cpu_memoryread_d_codefetch(a)	memp_read32_codefetch(a)
+/* memf_* : inlined host load/store in flat memory mode, memp_* otherwise */
+#define	cpu_memorywrite(a,v)	memf_write8(a,v)
+#define	cpu_memorywrite_b(a,v)	memf_write8(a,v)
+#define	cpu_memorywrite_w(a,v)	memf_write16(a,v)
+#define	cpu_memorywrite_d(a,v)	memf_write32(a,v)
+#define	cpu_memoryread(a)	memf_read8(a)
+#define	cpu_memoryread_b(a)	memf_read8(a)
+#define	cpu_memoryread_w(a)	memf_read16(a)
+#define	cpu_memoryread_d(a)	memf_read32(a)
+#define	cpu_memoryread_codefetch(a)		memf_read8_codefetch(a)
+#define	cpu_memoryread_b_codefetch(a)	memf_read8_codefetch(a)
+#define	cpu_memoryread_w_codefetch(a)	memf_read16_codefetch(a)
+#define	cpu_memoryread_d_codefetch(a)	memf_read32_codefetch(a)
 #ifdef USE_FASTPAGING
 #define	cpu_memoryread_paging(a)		memp_read8_paging(a)
 #define	cpu_memoryread_b_paging(a)		memp_read8_paging(a)
@@ -81,14 +82,14 @@
 #define	cpu_memorywrite_w_paging(a,v)	memp_write16_paging(a,v)
 #define	cpu_memorywrite_d_paging(a,v)	memp_write32_paging(a,v)
 #else
-#define	cpu_memoryread_paging(a)		memp_read8_codefetch(a)
-#define	cpu_memoryread_b_paging(a)		memp_read8_codefetch(a)
-#define	cpu_memoryread_w_paging(a)		memp_read16_codefetch(a)
-#define	cpu_memoryread_d_paging(a)		memp_read32_codefetch(a)
-#define	cpu_memorywrite_paging(a,v)		memp_write8(a,v)
-#define	cpu_memorywrite_b_paging(a,v)	memp_write8(a,v)
-#define	cpu_memorywrite_w_paging(a,v)	memp_write16(a,v)
-#define	cpu_memorywrite_d_paging(a,v)	memp_write32(a,v)
+#define	cpu_memoryread_paging(a)		memf_read8_codefetch(a)
+#define	cpu_memoryread_b_paging(a)		memf_read8_codefetch(a)
+#define	cpu_memoryread_w_paging(a)		memf_read16_codefetch(a)
+#define	cpu_memoryread_d_paging(a)		memf_read32_codefetch(a)
+#define	cpu_memorywrite_paging(a,v)		memf_write8(a,v)
+#define	cpu_memorywrite_b_paging(a,v)	memf_write8(a,v)
+#define	cpu_memorywrite_w_paging(a,v)	memf_write16(a,v)
+#define	cpu_memorywrite_d_paging(a,v)	memf_write32(a,v)
 #endif
 
 #define	cpu_memoryread_region(a,p,l)	memp_reads(a,p,l)
@@ -3650,7 +3650,7 @@ bool CPU_WRITE_CRX(Bitu cr, Bitu value) {
 		CPU_CR0 = src;
 		VERBOSE(("MOV_CdRd: %04x:%08x: cr0: 0x%08x <- 0x%08x(%s)", CPU_CS, CPU_PREV_EIP, reg, CPU_CR0, reg32_str[op & 7]));
 
-		if ((reg ^ CPU_CR0) & (CPU_CR0_PE | CPU_CR0_PG)) {
+		if ((reg ^ CPU_CR0) & (CPU_CR0_PE | CPU_CR0_PG | CPU_CR0_WP)) {
 			tlb_flush_all();
 		}
 		if ((reg ^ CPU_CR0) & CPU_CR0_PE) {
@@ -3993,6 +3993,7 @@ bool CPU_SetSegGeneral(SegNames seg, uint16_t value) {
 		if (!CPU_STAT_PM || CPU_STAT_VM86) {
 			CPU_STATSAVE.cpu_regs.sreg[seg] = value;
 			CPU_STATSAVE.cpu_stat.sreg[seg].u.seg.segbase = value << 4;
+			CPU_STATSAVE.cpu_stat.sreg[seg].flag &= ~CPU_DESC_FLAG_FLAT;
 			return false;
 		}
 		else {
@@ -153,6 +153,12 @@ static const UINT8 page_access_bit[32] = {
 };
 #endif	/* !USE_PAGE_ACCESS_TABLE */
 
+#if !defined(USE_PAGE_ACCESS_TABLE)
+#define	PAGE_ACCESS_OK(bit)	(page_access & (1 << (bit)))
+#else
+#define	PAGE_ACCESS_OK(bit)	(page_access_bit[(bit)])
+#endif
+
 /*
  *--
  * 32bit AhX 4k y[W
@@ -180,20 +186,34 @@ static const UINT8 page_access_bit[32] = {
  * +- CR3(AhX)
  */
 /* TLB */
-struct tlb_entry {
-	UINT32	tag;	/* linear address */
-#define	TLB_ENTRY_TAG_VALID		(1 << 0)
-/*	pde & pte & CPU_PTE_WRITABLE	(1 << 1)	*/
-/*	pde & pte & CPU_PTE_USER_MODE	(1 << 2)	*/
-#define	TLB_ENTRY_TAG_DIRTY		CPU_PTE_DIRTY		/* (1 << 6) */
-#define	TLB_ENTRY_TAG_GLOBAL		CPU_PTE_GLOBAL_PAGE	/* (1 << 8) */
-#define	TLB_ENTRY_TAG_MAX_SHIFT		12
-	UINT32	paddr;	/* physical address */
+struct tlb2_entry {
+	UINT32	tag;		/* page (4MB page) linear address */
+	UINT32	addend;		/* paddr - laddr */
+	UINT32	flags;
+#define	TLB2_FLAG_READ		(1 << 0)
+#define	TLB2_FLAG_WRITE		(1 << 1)
+/*	TLB_ENTRY_FLAG_GLOBAL	(1 << 8) */
 };
-static void MEMCALL tlb_update(UINT32 laddr, UINT entry, int ucrw);
+
+struct pde_cache_entry {
+	UINT32	tag;		/* 4MB aligned linear address */
+	UINT32	pde;
+};
+
+struct tlb_entry i386tlb[TLB_NMODE][TLB_NENTRY];
+static struct tlb2_entry i386tlb2[TLB_NMODE][TLB2_NSET][TLB2_NWAY];
+static UINT8 i386tlb2_victim[TLB_NMODE][TLB2_NSET];
+static struct tlb2_entry i386tlb_large[TLB_NMODE][TLB_NLARGE];
+static struct pde_cache_entry pde_cache[TLB_PDE_CACHE_NENTRY];
+I386TLBSTAT i386tlbstat;
+
+static struct tlb2_entry * MEMCALL tlb2_lookup(UINT32 laddr, int ucrw);
+static void MEMCALL tlb_set(struct tlb_entry *ep, UINT32 page, UINT32 addend, UINT32 flags);
+static void MEMCALL tlb_update(UINT32 laddr, UINT32 pxe, UINT bit, int ucrw, int large);
 
 /* paging */
 static UINT32 MEMCALL paging(UINT32 laddr, int ucrw);
+static UINT32 MEMCALL paging_4m(UINT32 laddr, int ucrw, UINT32 pde_addr, UINT32 pde);
 
 /*
  * linear memory access
@@ -506,6 +526,29 @@ cpu_linear_memory_read_f(UINT32 laddr, int ucrw)
 	return value;
 }
 
+XMM_REG MEMCALL
+cpu_linear_memory_read_dq(UINT32 laddr, int ucrw)
+{
+	UINT32 paddr[2];
+	XMM_REG value;
+	UINT remain;
+	UINT i, j;
+
+	paddr[0] = paging(laddr, ucrw);
+	remain = CPU_PAGE_SIZE - (laddr & CPU_PAGE_MASK);
+	if (remain >= sizeof(value))
+		return cpu_memoryread_dq(paddr[0]);
+
+	paddr[1] = paging(laddr + remain, ucrw);
+	for (i = 0; i < remain; ++i) {
+		value.ul8[i] = cpu_memoryread(paddr[0] + i);
+	}
+	for (j = 0; i < sizeof(value); ++i, ++j) {
+		value.ul8[i] = cpu_memoryread(paddr[1] + j);
+	}
+	return value;
+}
+
 /* write */
 void MEMCALL
 cpu_linear_memory_write_b(UINT32 laddr, UINT8 value, int ucrw)
@@ -657,6 +700,29 @@ cpu_linear_memory_write_f(UINT32 laddr, const REG80 *value, int ucrw)
 	}
 }
 
+void MEMCALL
+cpu_linear_memory_write_dq(UINT32 laddr, const XMM_REG *value, int ucrw)
+{
+	UINT32 paddr[2];
+	UINT remain;
+	UINT i, j;
+
+	paddr[0] = paging(laddr, ucrw);
+	remain = CPU_PAGE_SIZE - (laddr & CPU_PAGE_MASK);
+	if (remain >= sizeof(*value)) {
+		cpu_memorywrite_dq(paddr[0], value);
+		return;
+	}
+
+	paddr[1] = paging(laddr + remain, ucrw);
+	for (i = 0; i < remain; ++i) {
+		cpu_memorywrite(paddr[0] + i, value->ul8[i]);
+	}
+	for (j = 0; i < sizeof(*value); ++i, ++j) {
+		cpu_memorywrite(paddr[1] + j, value->ul8[i]);
+	}
+}
+
 /*
  * linear address memory access function
  */
@@ -702,6 +768,8 @@ static UINT32 MEMCALL
 paging(UINT32 laddr, int ucrw)
 {
 	struct tlb_entry *ep;
+	struct tlb2_entry *ep2;
+	struct pde_cache_entry *pc;
 	UINT32 paddr;		/* physical address */
 	UINT32 pde_addr;	/* page directory entry address */
 	UINT32 pde;		/* page directory entry */
@@ -711,25 +779,47 @@ paging(UINT32 laddr, int ucrw)
 	UINT err;
 
 	ep = tlb_lookup(laddr, ucrw);
-	if (ep != NULL)
-		return ep->paddr + (laddr & CPU_PAGE_MASK);
+	if (ep != NULL) {
+		i386tlbstat.l1_hit++;
+		return laddr + ep->addend;
+	}
+	ep2 = tlb2_lookup(laddr, ucrw);
+	if (ep2 != NULL) {
+		tlb_set(TLB_ENTRY(laddr, ucrw), laddr & ~CPU_PAGE_MASK, ep2->addend, ep2->flags);
+		return laddr + ep2->addend;
+	}
+	i386tlbstat.miss++;
 
 	pde_addr = CPU_STAT_PDE_BASE + ((laddr >> 20) & 0xffc);
-	pde = cpu_memoryread_d_paging(pde_addr);
-	if (!(pde & CPU_PDE_PRESENT)) {
-		VERBOSE(("paging: PTE page is not present"));
-		VERBOSE(("paging: CPU_CR3 = 0x%08x", CPU_CR3));
-		VERBOSE(("paging: laddr = 0x%08x, pde_addr = 0x%08x, pde = 0x%08x", laddr, pde_addr, pde));
-		err = 0;
-		goto pf_exception;
-	}
-	if (!(pde & CPU_PDE_ACCESS)) {
-		pde |= CPU_PDE_ACCESS;
-		cpu_memorywrite_d_paging(pde_addr, pde);
+	pc = &pde_cache[(laddr >> 22) & (TLB_PDE_CACHE_NENTRY - 1)];
+	if (pc->tag == (laddr & CPU_PDE_4M_BASEADDR_MASK)) {
+		i386tlbstat.pde_hit++;
+		pde = pc->pde;
+	} else {
+		pde = cpu_memoryread_d_paging(pde_addr);
+		i386tlbstat.walk_read++;
+		if (!(pde & CPU_PDE_PRESENT)) {
+			VERBOSE(("paging: PTE page is not present"));
+			VERBOSE(("paging: CPU_CR3 = 0x%08x", CPU_CR3));
+			VERBOSE(("paging: laddr = 0x%08x, pde_addr = 0x%08x, pde = 0x%08x", laddr, pde_addr, pde));
+			err = 0;
+			goto pf_exception;
+		}
+		if (!(pde & CPU_PDE_ACCESS)) {
+			pde |= CPU_PDE_ACCESS;
+			cpu_memorywrite_d_paging(pde_addr, pde);
+			i386tlbstat.walk_write++;
+		}
+		if ((CPU_CR4 & CPU_CR4_PSE) && (pde & CPU_PDE_PAGE_SIZE)) {
+			return paging_4m(laddr, ucrw, pde_addr, pde);
+		}
+		pc->tag = laddr & CPU_PDE_4M_BASEADDR_MASK;
+		pc->pde = pde;
 	}
 
 	pte_addr = (pde & CPU_PDE_BASEADDR_MASK) + ((laddr >> 10) & 0xffc);
 	pte = cpu_memoryread_d_paging(pte_addr);
+	i386tlbstat.walk_read++;
 	if (!(pte & CPU_PTE_PRESENT)) {
 		VERBOSE(("paging: page is not present"));
 		VERBOSE(("paging: laddr = 0x%08x, pde_addr = 0x%08x, pde = 0x%08x", laddr, pde_addr, pde));
@@ -740,6 +830,7 @@ paging(UINT32 laddr, int ucrw)
 	if (!(pte & CPU_PTE_ACCESS)) {
 		pte |= CPU_PTE_ACCESS;
 		cpu_memorywrite_d_paging(pte_addr, pte);
+		i386tlbstat.walk_write++;
 	}
 
 	/* make physical address */
@@ -749,12 +840,7 @@ paging(UINT32 laddr, int ucrw)
 	bit |= (pde & pte & (CPU_PTE_WRITABLE|CPU_PTE_USER_MODE));
 	bit |= CPU_STAT_WP;
 
-#if !defined(USE_PAGE_ACCESS_TABLE)
-	if (!(page_access & (1 << bit)))
-#else
-	if (!(page_access_bit[bit]))
-#endif
-	{
+	if (!PAGE_ACCESS_OK(bit)) {
 		VERBOSE(("paging: page access violation."));
 		VERBOSE(("paging: laddr = 0x%08x, pde_addr = 0x%08x, pde = 0x%08x", laddr, pde_addr, pde));
 		VERBOSE(("paging: pte_addr = 0x%08x, pte = 0x%08x", pte_addr, pte));
@@ -766,9 +852,10 @@ paging(UINT32 laddr, int ucrw)
 	if ((ucrw & CPU_PAGE_WRITE) && !(pte & CPU_PTE_DIRTY)) {
 		pte |= CPU_PTE_DIRTY;
 		cpu_memorywrite_d_paging(pte_addr, pte);
+		i386tlbstat.walk_write++;
 	}
 
-	tlb_update(laddr, pte, (bit & (CPU_PTE_WRITABLE|CPU_PTE_USER_MODE)) + ((ucrw & CPU_PAGE_CODE) ? 1 : 0));
+	tlb_update(laddr, pte, bit, ucrw, 0);
 
 	return paddr;
 
@@ -780,73 +867,147 @@ pf_exception:
 	return 0;	/* compiler happy */
 }
 
+/*
+ * 4MB page (CR4.PSE && PDE.PS), pde has the access bit set already
+ */
+static UINT32 MEMCALL
+paging_4m(UINT32 laddr, int ucrw, UINT32 pde_addr, UINT32 pde)
+{
+	UINT32 paddr;		/* physical address */
+	UINT bit;
+	UINT err;
+
+	paddr = (pde & CPU_PDE_4M_BASEADDR_MASK) + (laddr & ~CPU_PDE_4M_BASEADDR_MASK);
+
+	bit  = ucrw & (CPU_PAGE_WRITE|CPU_PAGE_USER_MODE);
+	bit |= (pde & (CPU_PDE_4M_WRITABLE|CPU_PDE_4M_USER_MODE));
+	bit |= CPU_STAT_WP;
+
+	if (!PAGE_ACCESS_OK(bit)) {
+		VERBOSE(("paging_4m: page access violation."));
+		VERBOSE(("paging_4m: laddr = 0x%08x, pde_addr = 0x%08x, pde = 0x%08x", laddr, pde_addr, pde));
+		VERBOSE(("paging_4m: paddr = 0x%08x, bit = 0x%08x", paddr, bit));
+		CPU_CR2 = laddr;
+		err = 1;
+		err |= (ucrw & CPU_PAGE_WRITE) << 1;
+		err |= (ucrw & CPU_PAGE_USER_MODE) >> 1;
+		EXCEPTION(PF_EXCEPTION, err);
+	}
+
+	if ((ucrw & CPU_PAGE_WRITE) && !(pde & CPU_PDE_4M_DIRTY)) {
+		pde |= CPU_PDE_4M_DIRTY;
+		cpu_memorywrite_d_paging(pde_addr, pde);
+		i386tlbstat.walk_write++;
+	}
+
+	tlb_update(laddr, pde, bit, ucrw, 1);
+
+	return paddr;
+}
+
 /* 
  * TLB
  */
-#define	TLB_TAG_SHIFT		TLB_ENTRY_TAG_MAX_SHIFT
-#define	TLB_TAG_MASK		(~((1 << TLB_TAG_SHIFT) - 1))
-#define	TLB_GET_TAG_ADDR(ep)	((ep)->tag & TLB_TAG_MASK)
-#define	TLB_SET_TAG_ADDR(ep, addr) \
+#define	TLB_SET_INVALID(ep) \
 do { \
-	(ep)->tag &= ~TLB_TAG_MASK; \
-	(ep)->tag |= (addr) & TLB_TAG_MASK; \
-} while (/*CONSTCOND(*/ 0)
-
-#define	TLB_IS_VALID(ep)	((ep)->tag & TLB_ENTRY_TAG_VALID)
-#define	TLB_SET_VALID(ep)	((ep)->tag = TLB_ENTRY_TAG_VALID)
-#define	TLB_SET_INVALID(ep)	((ep)->tag = 0)
+	(ep)->tag_read = TLB_TAG_INVALID; \
+	(ep)->tag_write = TLB_TAG_INVALID; \
+	(ep)->tag_code = TLB_TAG_INVALID; \
+	(ep)->flags = 0; \
+} while (/*CONSTCOND*/ 0)
 
-#define	TLB_IS_WRITABLE(ep)	((ep)->tag & CPU_PTE_WRITABLE)
-#define	TLB_IS_USERMODE(ep)	((ep)->tag & CPU_PTE_USER_MODE)
-#define	TLB_IS_DIRTY(ep)	((ep)->tag & TLB_ENTRY_TAG_DIRTY)
 #if (CPU_FEATURES & CPU_FEATURE_PGE) == CPU_FEATURE_PGE
-#define	TLB_IS_GLOBAL(ep)	((ep)->tag & TLB_ENTRY_TAG_GLOBAL)
+#define	TLB_IS_GLOBAL(ep)	((ep)->flags & TLB_ENTRY_FLAG_GLOBAL)
 #else
 #define	TLB_IS_GLOBAL(ep)	0
 #endif
 
-#define	TLB_SET_TAG_FLAGS(ep, entry, bit) \
-do { \
-	(ep)->tag |= (entry) & (CPU_PTE_GLOBAL_PAGE|CPU_PTE_DIRTY); \
-	(ep)->tag |= (bit) & (CPU_PTE_WRITABLE|CPU_PTE_USER_MODE); \
-} while (/*CONSTCOND*/ 0)
+/* i386tlb entry has a tag inside [base, base + 4MB) */
+#define	TLB_IN_LARGE(ep, base) \
+	(TLB_TAG_IN_LARGE((ep)->tag_read, (base)) \
+	 || TLB_TAG_IN_LARGE((ep)->tag_write, (base)) \
+	 || TLB_TAG_IN_LARGE((ep)->tag_code, (base)))
+#define	TLB_TAG_IN_LARGE(tag, base) \
+	(((tag) != TLB_TAG_INVALID) && (((tag) & CPU_PDE_4M_BASEADDR_MASK) == (base)))
 
-#define	NTLB		2	/* 0: DTLB, 1: ITLB */
-#define	NENTRY		(1 << 6)
-#define	TLB_ENTRY_SHIFT	12
-#define	TLB_ENTRY_MASK	(NENTRY - 1)
+static void
+pde_cache_flush(void)
+{
+	int i;
 
-typedef struct {
-	struct tlb_entry entry[NENTRY];
-} tlb_t;
-static tlb_t tlb[NTLB];
+	for (i = 0; i < TLB_PDE_CACHE_NENTRY; i++) {
+		pde_cache[i].tag = TLB_TAG_INVALID;
+	}
+}
 
 void
 tlb_init(void)
 {
-	memset(tlb, 0, sizeof(tlb));
+	struct tlb_entry *ep;
+	int i, j;
+	int n;
+
+	for (n = 0; n < TLB_NMODE; n++) {
+		for (i = 0; i < TLB_NENTRY; i++) {
+			ep = &i386tlb[n][i];
+			TLB_SET_INVALID(ep);
+		}
+		for (i = 0; i < TLB2_NSET; i++) {
+			for (j = 0; j < TLB2_NWAY; j++) {
+				i386tlb2[n][i][j].tag = TLB_TAG_INVALID;
+				i386tlb2[n][i][j].flags = 0;
+			}
+			i386tlb2_victim[n][i] = 0;
+		}
+		for (i = 0; i < TLB_NLARGE; i++) {
+			i386tlb_large[n][i].tag = TLB_TAG_INVALID;
+			i386tlb_large[n][i].flags = 0;
+		}
+	}
+	pde_cache_flush();
+	CPU_CLEARPREFETCH();
 }
 
 void MEMCALL
 tlb_flush()
 {
 	struct tlb_entry *ep;
-	int i;
+	struct tlb2_entry *ep2;
+	int i, j;
 	int n;
 
-	for (n = 0; n < NTLB; n++) {
-		for (i = 0; i < NENTRY ; i++) {
-			ep = &tlb[n].entry[i];
-			if (TLB_IS_VALID(ep) && !TLB_IS_GLOBAL(ep)) {
+	i386tlbstat.flush++;
+	for (n = 0; n < TLB_NMODE; n++) {
+		for (i = 0; i < TLB_NENTRY; i++) {
+			ep = &i386tlb[n][i];
+			if (!TLB_IS_GLOBAL(ep)) {
 				TLB_SET_INVALID(ep);
 			}
 		}
+		for (i = 0; i < TLB2_NSET; i++) {
+			for (j = 0; j < TLB2_NWAY; j++) {
+				ep2 = &i386tlb2[n][i][j];
+				if (!TLB_IS_GLOBAL(ep2)) {
+					ep2->tag = TLB_TAG_INVALID;
+				}
+			}
+		}
+		for (i = 0; i < TLB_NLARGE; i++) {
+			ep2 = &i386tlb_large[n][i];
+			if (!TLB_IS_GLOBAL(ep2)) {
+				ep2->tag = TLB_TAG_INVALID;
+			}
+		}
 	}
+	pde_cache_flush();
+	CPU_CLEARPREFETCH();
 }
 
 void MEMCALL
 tlb_flush_all()
 {
+
+	i386tlbstat.flush_all++;
 	tlb_init();
 }
 
@@ -854,66 +1015,159 @@ void MEMCALL
 tlb_flush_page(UINT32 laddr)
 {
 	struct tlb_entry *ep;
-	int idx;
+	struct tlb2_entry *ep2;
+	UINT32 page;
+	UINT32 base;
+	int i;
 	int n;
 
-	idx = (laddr >> TLB_ENTRY_SHIFT) & TLB_ENTRY_MASK;
-
-	for (n = 0; n < NTLB; n++) {
-		ep = &tlb[n].entry[idx];
-		if (TLB_IS_VALID(ep)) {
-			if ((laddr & TLB_TAG_MASK) == TLB_GET_TAG_ADDR(ep)) {
-				TLB_SET_INVALID(ep);
+	i386tlbstat.flush_page++;
+	page = laddr & ~CPU_PAGE_MASK;
+	base = laddr & CPU_PDE_4M_BASEADDR_MASK;
+	for (n = 0; n < TLB_NMODE; n++) {
+		ep = &i386tlb[n][(laddr >> 12) & (TLB_NENTRY - 1)];
+		if (ep->tag_read == page
+		 || ep->tag_write == page
+		 || ep->tag_code == page) {
+			TLB_SET_INVALID(ep);
+		}
+		for (i = 0; i < TLB2_NWAY; i++) {
+			ep2 = &i386tlb2[n][(laddr >> 12) & (TLB2_NSET - 1)][i];
+			if (ep2->tag == page) {
+				ep2->tag = TLB_TAG_INVALID;
+			}
+		}
+		ep2 = &i386tlb_large[n][(laddr >> 22) & (TLB_NLARGE - 1)];
+		if (ep2->tag == base) {
+			/* i386tlb may hold any 4KB piece of it */
+			ep2->tag = TLB_TAG_INVALID;
+			for (i = 0; i < TLB_NENTRY; i++) {
+				ep = &i386tlb[n][i];
+				if (TLB_IN_LARGE(ep, base)) {
+					TLB_SET_INVALID(ep);
+				}
 			}
 		}
 	}
+	pde_cache_flush();
+	CPU_CLEARPREFETCH();
 }
 
 struct tlb_entry * MEMCALL
 tlb_lookup(UINT32 laddr, int ucrw)
 {
 	struct tlb_entry *ep;
-	UINT bit;
-	int idx;
-	int n;
+	UINT32 tag;
+
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (ucrw & CPU_PAGE_WRITE) {
+		tag = ep->tag_write;
+	} else if (ucrw & CPU_PAGE_CODE) {
+		tag = ep->tag_code;
+	} else {
+		tag = ep->tag_read;
+	}
+	if (tag == (laddr & ~CPU_PAGE_MASK)) {
+		return ep;
+	}
+	return NULL;
+}
 
-	n = (ucrw & CPU_PAGE_CODE) ? 1 : 0;
-	idx = (laddr >> TLB_ENTRY_SHIFT) & TLB_ENTRY_MASK;
-	ep = &tlb[n].entry[idx];
+static struct tlb2_entry * MEMCALL
+tlb2_lookup(UINT32 laddr, int ucrw)
+{
+	struct tlb2_entry *ep2;
+	UINT32 need;
+	int mode;
+	int i;
 
-	if (TLB_IS_VALID(ep)) {
-		if ((laddr & TLB_TAG_MASK) == TLB_GET_TAG_ADDR(ep)) {
-			bit = ucrw & (CPU_PAGE_WRITE|CPU_PAGE_USER_MODE);
-			bit |= ep->tag & (CPU_PTE_WRITABLE|CPU_PTE_USER_MODE);
-			bit |= CPU_STAT_WP;
-#if !defined(USE_PAGE_ACCESS_TABLE)
-			if ((page_access & (1 << bit)))
-#else
-			if (page_access_bit[bit])
-#endif
-			{
-				if (!(ucrw & CPU_PAGE_WRITE) || TLB_IS_DIRTY(ep)) {
-					return ep;
-				}
-			}
+	need = (ucrw & CPU_PAGE_WRITE) ? TLB2_FLAG_WRITE : TLB2_FLAG_READ;
+	mode = (ucrw & CPU_PAGE_USER_MODE) >> 3;
+
+	ep2 = i386tlb2[mode][(laddr >> 12) & (TLB2_NSET - 1)];
+	for (i = 0; i < TLB2_NWAY; i++, ep2++) {
+		if (ep2->tag == (laddr & ~CPU_PAGE_MASK) && (ep2->flags & need)) {
+			i386tlbstat.l2_hit++;
+			return ep2;
 		}
 	}
+	ep2 = &i386tlb_large[mode][(laddr >> 22) & (TLB_NLARGE - 1)];
+	if (ep2->tag == (laddr & CPU_PDE_4M_BASEADDR_MASK) && (ep2->flags & need)) {
+		i386tlbstat.large_hit++;
+		return ep2;
+	}
 	return NULL;
 }
 
 static void MEMCALL
-tlb_update(UINT32 laddr, UINT entry, int bit)
+tlb_set(struct tlb_entry *ep, UINT32 page, UINT32 addend, UINT32 flags)
 {
-	struct tlb_entry *ep;
-	int idx;
-	int n;
 
-	n = bit & 1;
-	idx = (laddr >> TLB_ENTRY_SHIFT) & TLB_ENTRY_MASK;
-	ep = &tlb[n].entry[idx];
+	TLB_SET_INVALID(ep);
+	if (flags & TLB2_FLAG_READ) {
+		ep->tag_read = page;
+		ep->tag_code = page;
+	}
+	if (flags & TLB2_FLAG_WRITE) {
+		ep->tag_write = page;
+	}
+	ep->addend = addend;
+	ep->flags = flags & TLB_ENTRY_FLAG_GLOBAL;
+}
+
+/*
+ * bit: page_access index of the walk that just succeeded.
+ * Permissions of the other access kinds at the same privilege are
+ * derived from it, so later reads/writes of the page skip the walk.
+ * pxe is the PTE, or the PDE of a 4MB page when large is set.
+ */
+static void MEMCALL
+tlb_update(UINT32 laddr, UINT32 pxe, UINT bit, int ucrw, int large)
+{
+	struct tlb2_entry *ep2;
+	UINT32 base;
+	UINT32 addend;
+	UINT32 flags;
+	int mode;
+	int i;
+
+	mode = (ucrw & CPU_PAGE_USER_MODE) >> 3;
+	if (!large) {
+		base = laddr & ~CPU_PAGE_MASK;
+		addend = (pxe & CPU_PTE_BASEADDR_MASK) - base;
+	} else {
+		base = laddr & CPU_PDE_4M_BASEADDR_MASK;
+		addend = (pxe & CPU_PDE_4M_BASEADDR_MASK) - base;
+	}
+
+	flags = 0;
+	if (PAGE_ACCESS_OK(bit & ~CPU_PAGE_WRITE)) {
+		flags |= TLB2_FLAG_READ;
+	}
+	if ((pxe & CPU_PTE_DIRTY) && PAGE_ACCESS_OK(bit | CPU_PAGE_WRITE)) {
+		flags |= TLB2_FLAG_WRITE;
+	}
+	if (CPU_CR4 & CPU_CR4_PGE) {
+		flags |= pxe & TLB_ENTRY_FLAG_GLOBAL;
+	}
+
+	if (!large) {
+		ep2 = i386tlb2[mode][(laddr >> 12) & (TLB2_NSET - 1)];
+		for (i = 0; i < TLB2_NWAY; i++) {
+			if (ep2[i].tag == base)
+				break;
+		}
+		if (i == TLB2_NWAY) {
+			/* round robin replacement */
+			i = i386tlb2_victim[mode][(laddr >> 12) & (TLB2_NSET - 1)]++ % TLB2_NWAY;
+		}
+		ep2 += i;
+	} else {
+		ep2 = &i386tlb_large[mode][(laddr >> 22) & (TLB_NLARGE - 1)];
+	}
+	ep2->tag = base;
+	ep2->addend = addend;
+	ep2->flags = flags;
 
-	TLB_SET_VALID(ep);
-	TLB_SET_TAG_ADDR(ep, laddr);
-	TLB_SET_TAG_FLAGS(ep, entry, bit);
-	ep->paddr = entry & CPU_PTE_BASEADDR_MASK;
+	tlb_set(TLB_ENTRY(laddr, ucrw), laddr & ~CPU_PAGE_MASK, addend, flags);
 }
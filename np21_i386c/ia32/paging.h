@@ -143,11 +143,84 @@ UINT8 MEMCALL cpu_linear_memory_read_b_codefetch(UINT32 laddr, int ucrw);
 UINT16 MEMCALL cpu_linear_memory_read_w_codefetch(UINT32 laddr, int ucrw);
 UINT32 MEMCALL cpu_linear_memory_read_d_codefetch(UINT32 laddr, int ucrw);
 REG80 MEMCALL cpu_linear_memory_read_f(UINT32 laddr, int ucrw);
+XMM_REG MEMCALL cpu_linear_memory_read_dq(UINT32 laddr, int ucrw);
 void MEMCALL cpu_linear_memory_write_b(UINT32 laddr, UINT8 value, int ucrw);
 void MEMCALL cpu_linear_memory_write_w(UINT32 laddr, UINT16 value, int ucrw);
 void MEMCALL cpu_linear_memory_write_d(UINT32 laddr, UINT32 value, int ucrw);
 void MEMCALL cpu_linear_memory_write_q(UINT32 laddr, UINT64 value, int ucrw);
 void MEMCALL cpu_linear_memory_write_f(UINT32 laddr, const REG80 *value, int ucrw);
+void MEMCALL cpu_linear_memory_write_dq(UINT32 laddr, const XMM_REG *value, int ucrw);
+
+/*
+ * TLB
+ *
+ * Direct mapped, one table per privilege (ucrw & CPU_PAGE_USER_MODE).
+ * Each entry keeps a read, write and code tag holding the page linear
+ * address when that access is allowed without a page walk, and the
+ * addend turning the linear address into the physical (in flat memory
+ * mode: host) address.  tag_write is only set once the PTE is dirty.
+ */
+struct tlb_entry {
+	UINT32	tag_read;
+	UINT32	tag_write;
+	UINT32	tag_code;
+	UINT32	addend;		/* paddr - laddr */
+	UINT32	flags;
+#define	TLB_ENTRY_FLAG_GLOBAL	CPU_PTE_GLOBAL_PAGE
+};
+
+#define	TLB_TAG_INVALID		0xffffffff	/* never page aligned */
+#define	TLB_NENTRY_SHIFT	8
+#define	TLB_NENTRY		(1 << TLB_NENTRY_SHIFT)
+#define	TLB_NMODE		2	/* 0: supervisor, 1: user */
+
+extern struct tlb_entry i386tlb[TLB_NMODE][TLB_NENTRY];
+
+#define	TLB_ENTRY(laddr, ucrw) \
+	(&i386tlb[((ucrw) & CPU_PAGE_USER_MODE) >> 3][((laddr) >> 12) & (TLB_NENTRY - 1)])
+/*
+ * Second level TLB
+ *
+ * i386tlb misses are looked up in a TLB2_NSET x TLB2_NWAY set
+ * associative table (4KB pages) and a small direct mapped table of
+ * 4MB pages (CR4.PSE) before walking the page tables.  Both are kept
+ * per privilege like i386tlb.
+ */
+#if !defined(TLB2_NSET_SHIFT)
+#define	TLB2_NSET_SHIFT		10
+#endif
+#if !defined(TLB2_NWAY)
+#define	TLB2_NWAY		4
+#endif
+#define	TLB2_NSET		(1 << TLB2_NSET_SHIFT)
+#define	TLB_NLARGE		16
+#define	TLB_PDE_CACHE_NENTRY	16
+
+/*
+ * TLB statistics (CPU_GET_REGPTR(8))
+ *
+ * Hits of the inline accessors are not counted; l1_hit only counts
+ * the i386tlb hits of accesses that went through paging().
+ */
+typedef struct {
+	UINT64	l1_hit;
+	UINT64	l2_hit;		/* TLB2 (4KB) */
+	UINT64	large_hit;	/* 4MB page */
+	UINT64	miss;		/* page walks */
+	UINT64	pde_hit;	/* walks that used a cached PDE */
+	UINT64	walk_read;	/* PDE/PTE reads */
+	UINT64	walk_write;	/* A/D bit updates */
+	UINT64	flush;
+	UINT64	flush_all;
+	UINT64	flush_page;
+} I386TLBSTAT;
+
+extern I386TLBSTAT i386tlbstat;
+
+/* tag hit and [laddr, laddr + size) does not cross the page */
+#define	TLB_HIT(tag, laddr, size) \
+	(((tag) == ((laddr) & ~CPU_PAGE_MASK)) \
+	 && (((laddr) & CPU_PAGE_MASK) <= CPU_PAGE_SIZE - (size)))
 
 /*
  * linear address memory access function with TLB
@@ -156,6 +229,7 @@ void MEMCALL cpu_linear_memory_write_f(UINT32 laddr, const REG80 *value, int ucr
 STATIC_INLINE UINT8 MEMCALL
 cpu_lmemory_RMW_b(UINT32 laddr, UINT32 (CPUCALL *func)(UINT32, void *), void *arg)
 {
+	struct tlb_entry *ep;
 	UINT32 result;
 	UINT8 value;
 
@@ -165,12 +239,21 @@ cpu_lmemory_RMW_b(UINT32 laddr, UINT32 (CPUCALL *func)(UINT32, void *), void *ar
 		cpu_memorywrite_b(laddr, (UINT8)result);
 		return value;
 	}
+	ep = TLB_ENTRY(laddr, CPU_STAT_USER_MODE);
+	if (TLB_HIT(ep->tag_write, laddr, 1)) {
+		laddr += ep->addend;
+		value = cpu_memoryread_b(laddr);
+		result = (*func)(value, arg);
+		cpu_memorywrite_b(laddr, (UINT8)result);
+		return value;
+	}
 	return cpu_memory_access_la_RMW_b(laddr, func, arg);
 }
 
 STATIC_INLINE UINT16 MEMCALL
 cpu_lmemory_RMW_w(UINT32 laddr, UINT32 (CPUCALL *func)(UINT32, void *), void *arg)
 {
+	struct tlb_entry *ep;
 	UINT32 result;
 	UINT16 value;
 
@@ -180,12 +263,21 @@ cpu_lmemory_RMW_w(UINT32 laddr, UINT32 (CPUCALL *func)(UINT32, void *), void *ar
 		cpu_memorywrite_w(laddr, (UINT16)result);
 		return value;
 	}
+	ep = TLB_ENTRY(laddr, CPU_STAT_USER_MODE);
+	if (TLB_HIT(ep->tag_write, laddr, 2)) {
+		laddr += ep->addend;
+		value = cpu_memoryread_w(laddr);
+		result = (*func)(value, arg);
+		cpu_memorywrite_w(laddr, (UINT16)result);
+		return value;
+	}
 	return cpu_memory_access_la_RMW_w(laddr, func, arg);
 }
 
 STATIC_INLINE UINT32 MEMCALL
 cpu_lmemory_RMW_d(UINT32 laddr, UINT32 (CPUCALL *func)(UINT32, void *), void *arg)
 {
+	struct tlb_entry *ep;
 	UINT32 result;
 	UINT32 value;
 
@@ -195,24 +287,95 @@ cpu_lmemory_RMW_d(UINT32 laddr, UINT32 (CPUCALL *func)(UINT32, void *), void *ar
 		cpu_memorywrite_d(laddr, result);
 		return value;
 	}
+	ep = TLB_ENTRY(laddr, CPU_STAT_USER_MODE);
+	if (TLB_HIT(ep->tag_write, laddr, 4)) {
+		laddr += ep->addend;
+		value = cpu_memoryread_d(laddr);
+		result = (*func)(value, arg);
+		cpu_memorywrite_d(laddr, result);
+		return value;
+	}
 	return cpu_memory_access_la_RMW_d(laddr, func, arg);
 }
 
+/*
+ * RMW with the operation known at compile time
+ *
+ * cpu_vmemory_RMW_paddr() gives the physical address when the access needs
+ * neither a limit check nor a page walk.  An accessor declared with
+ * DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW calls func directly in that case, so
+ * that the operation is inlined between the load and the store, and falls
+ * back to cpu_vmemory_RMW_*() otherwise.
+ */
+STATIC_INLINE BOOL
+cpu_vmemory_RMW_paddr(int idx, UINT32 offset, UINT length, UINT32 *paddr)
+{
+	descriptor_t *sdp;
+	struct tlb_entry *ep;
+	UINT32 laddr;
+
+	sdp = &CPU_STAT_SREG(idx);
+	if (CPU_STAT_PM && !SEG_IS_FLAT(sdp)) {
+		if (!SEG_IS_VALID(sdp))
+			return FALSE;
+		if ((sdp->flag & (CPU_DESC_FLAG_WRITABLE|CPU_DESC_FLAG_WHOLEADR))
+		    != (CPU_DESC_FLAG_WRITABLE|CPU_DESC_FLAG_WHOLEADR))
+			return FALSE;
+	}
+	laddr = sdp->u.seg.segbase + offset;
+
+	if (!CPU_STAT_PAGING) {
+		*paddr = laddr;
+		return TRUE;
+	}
+	ep = TLB_ENTRY(laddr, CPU_STAT_USER_MODE);
+	if (TLB_HIT(ep->tag_write, laddr, length)) {
+		*paddr = laddr + ep->addend;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+#define	DECLARE_VIRTUAL_ADDRESS_MEMORY_RMW(name, width, valtype, length, func) \
+STATIC_INLINE UINT32 \
+name(int idx, UINT32 offset, void *arg) \
+{ \
+	UINT32 paddr; \
+	UINT32 result; \
+	valtype value; \
+\
+	if (cpu_vmemory_RMW_paddr(idx, offset, (length), &paddr)) { \
+		value = cpu_memoryread_##width(paddr); \
+		result = func(value, arg); \
+		cpu_memorywrite_##width(paddr, (valtype)result); \
+		return value; \
+	} \
+	return cpu_vmemory_RMW_##width(idx, offset, func, arg); \
+}
+
 /* read */
 STATIC_INLINE UINT8 MEMCALL
 cpu_lmemoryread_b(UINT32 laddr, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING)
 		return cpu_memoryread_b(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_read, laddr, 1))
+		return cpu_memoryread_b(laddr + ep->addend);
 	return cpu_linear_memory_read_b(laddr, ucrw);
 }
 STATIC_INLINE UINT8 MEMCALL
 cpu_lmemoryread_b_codefetch(UINT32 laddr, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING)
 		return cpu_memoryread_b_codefetch(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_code, laddr, 1))
+		return cpu_memoryread_b_codefetch(laddr + ep->addend);
 	return cpu_linear_memory_read_b_codefetch(laddr, ucrw);
 }
 #define	cpu_lmemoryread(a,ucrw) cpu_lmemoryread_b((a),(ucrw))
@@ -221,17 +384,25 @@ cpu_lmemoryread_b_codefetch(UINT32 laddr, int ucrw)
 STATIC_INLINE UINT16 MEMCALL
 cpu_lmemoryread_w(UINT32 laddr, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING)
 		return cpu_memoryread_w(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_read, laddr, 2))
+		return cpu_memoryread_w(laddr + ep->addend);
 	return cpu_linear_memory_read_w(laddr, ucrw);
 }
 STATIC_INLINE UINT16 MEMCALL
 cpu_lmemoryread_w_codefetch(UINT32 laddr, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING)
 		return cpu_memoryread_w_codefetch(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_code, laddr, 2))
+		return cpu_memoryread_w_codefetch(laddr + ep->addend);
 	return cpu_linear_memory_read_w_codefetch(laddr, ucrw);
 }
 
@@ -239,17 +410,25 @@ cpu_lmemoryread_w_codefetch(UINT32 laddr, int ucrw)
 STATIC_INLINE UINT32 MEMCALL
 cpu_lmemoryread_d(UINT32 laddr, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING)
 		return cpu_memoryread_d(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_read, laddr, 4))
+		return cpu_memoryread_d(laddr + ep->addend);
 	return cpu_linear_memory_read_d(laddr, ucrw);
 }
 STATIC_INLINE UINT32 MEMCALL
 cpu_lmemoryread_d_codefetch(UINT32 laddr, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING)
 		return cpu_memoryread_d_codefetch(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_code, laddr, 4))
+		return cpu_memoryread_d_codefetch(laddr + ep->addend);
 	return cpu_linear_memory_read_d_codefetch(laddr, ucrw);
 }
 
@@ -271,15 +450,34 @@ cpu_lmemoryread_f(UINT32 laddr, int ucrw)
 	return cpu_linear_memory_read_f(laddr, ucrw);
 }
 
+STATIC_INLINE XMM_REG
+cpu_lmemoryread_dq(UINT32 laddr, int ucrw)
+{
+	struct tlb_entry *ep;
+
+	if (!CPU_STAT_PAGING)
+		return cpu_memoryread_dq(laddr);
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_read, laddr, 16))
+		return cpu_memoryread_dq(laddr + ep->addend);
+	return cpu_linear_memory_read_dq(laddr, ucrw);
+}
+
 /* write */
 STATIC_INLINE void MEMCALL
 cpu_lmemorywrite_b(UINT32 laddr, UINT8 value, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING) {
 		cpu_memorywrite_b(laddr, value);
 		return;
 	}
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_write, laddr, 1)) {
+		cpu_memorywrite_b(laddr + ep->addend, value);
+		return;
+	}
 	cpu_linear_memory_write_b(laddr, value, ucrw);
 }
 #define	cpu_lmemorywrite(a,v,ucrw) cpu_lmemorywrite_b((a),(v),(ucrw))
@@ -287,22 +485,34 @@ cpu_lmemorywrite_b(UINT32 laddr, UINT8 value, int ucrw)
 STATIC_INLINE void MEMCALL
 cpu_lmemorywrite_w(UINT32 laddr, UINT16 value, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING) {
 		cpu_memorywrite_w(laddr, value);
 		return;
 	}
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_write, laddr, 2)) {
+		cpu_memorywrite_w(laddr + ep->addend, value);
+		return;
+	}
 	cpu_linear_memory_write_w(laddr, value, ucrw);
 }
 
 STATIC_INLINE void MEMCALL
 cpu_lmemorywrite_d(UINT32 laddr, UINT32 value, int ucrw)
 {
+	struct tlb_entry *ep;
 
 	if (!CPU_STAT_PAGING) {
 		cpu_memorywrite_d(laddr, value);
 		return;
 	}
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_write, laddr, 4)) {
+		cpu_memorywrite_d(laddr + ep->addend, value);
+		return;
+	}
 	cpu_linear_memory_write_d(laddr, value, ucrw);
 }
 
@@ -328,6 +538,23 @@ cpu_lmemorywrite_f(UINT32 laddr, const REG80 *value, int ucrw)
 	cpu_linear_memory_write_f(laddr, value, ucrw);
 }
 
+STATIC_INLINE void MEMCALL
+cpu_lmemorywrite_dq(UINT32 laddr, const XMM_REG *value, int ucrw)
+{
+	struct tlb_entry *ep;
+
+	if (!CPU_STAT_PAGING) {
+		cpu_memorywrite_dq(laddr, value);
+		return;
+	}
+	ep = TLB_ENTRY(laddr, ucrw);
+	if (TLB_HIT(ep->tag_write, laddr, 16)) {
+		cpu_memorywrite_dq(laddr + ep->addend, value);
+		return;
+	}
+	cpu_linear_memory_write_dq(laddr, value, ucrw);
+}
+
 
 /*
  * linear address memory access with superviser mode
@@ -363,7 +590,6 @@ laddr_to_paddr(UINT32 laddr, int ucrw)
 /*
  * TLB function
  */
-struct tlb_entry;
 void tlb_init(void);
 void MEMCALL tlb_flush();
 void MEMCALL tlb_flush_all();
@@ -45,6 +45,66 @@ calc_ea_dst(UINT32 op)
 	return (*calc_ea32_dst_tbl[op])();
 }
 
+/*
+ * 32bit address size is known (CPU_STAT_FLAT32 without prefix)
+ *
+ * The ModR/M and SIB forms are decoded in line instead of through
+ * calc_ea32_dst_tbl.  CPU_INST_SEGREG_INDEX is not set: the flat32
+ * handlers use the address as the physical one.  EIP is 32bit there.
+ */
+STATIC_INLINE UINT32 CPUCALL
+calc_ea32_sib(UINT32 mod)
+{
+	UINT32 sib, base, idx, adrs;
+
+	sib = cpu_codefetch(CPU_EIP);
+	CPU_EIP++;
+	base = sib & 7;
+	idx = (sib >> 3) & 7;
+	if ((base == 5) && (mod == 0)) {
+		adrs = cpu_codefetch_d(CPU_EIP);
+		CPU_EIP += 4;
+	} else {
+		adrs = CPU_REGS_DWORD(base);
+	}
+	if (idx != 4)
+		adrs += CPU_REGS_DWORD(idx) << (sib >> 6);
+	return adrs;
+}
+
+STATIC_INLINE UINT32 CPUCALL
+calc_ea32_dst(UINT32 op)
+{
+	UINT32 rm = op & 7;
+	UINT32 adrs;
+
+	__ASSERT(op < 0xc0);
+
+	switch (op >> 6) {
+	case 0:
+		if (rm == 4)
+			return calc_ea32_sib(0);
+		if (rm == 5) {
+			adrs = cpu_codefetch_d(CPU_EIP);
+			CPU_EIP += 4;
+			return adrs;
+		}
+		return CPU_REGS_DWORD(rm);
+
+	case 1:
+		adrs = (rm == 4) ? calc_ea32_sib(1) : CPU_REGS_DWORD(rm);
+		adrs += (UINT32)(SINT8)cpu_codefetch(CPU_EIP);
+		CPU_EIP++;
+		return adrs;
+
+	default:
+		adrs = (rm == 4) ? calc_ea32_sib(2) : CPU_REGS_DWORD(rm);
+		adrs += cpu_codefetch_d(CPU_EIP);
+		CPU_EIP += 4;
+		return adrs;
+	}
+}
+
 //#ifdef __cplusplus
 //}
 //#endif
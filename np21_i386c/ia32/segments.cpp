@@ -44,6 +44,9 @@ load_segreg(int idx, UINT16 selector, UINT16 *sregp, descriptor_t *sdp, int exc)
 		*sregp = selector;
 		segdesc_set_default(idx, selector, &sel.desc);
 		*sdp = sel.desc;
+		if (idx == CPU_SS_INDEX) {
+			SS_UPDATE_FLAT32();
+		}
 		return;
 	}
 
@@ -55,6 +58,7 @@ load_segreg(int idx, UINT16 selector, UINT16 *sregp, descriptor_t *sdp, int exc)
 	if (idx == CPU_CS_INDEX) {
 		ia32_panic("load_segreg: CS");
 	}
+	CPU_STAT_FLAT32 = FLAT32_RECHECK;	/* looked at again after this insn */
 
 	rv = parse_selector(&sel, selector);
 	if (rv < 0) {
@@ -129,6 +133,7 @@ load_ss(UINT16 selector, const descriptor_t *sdp, int cpl)
 	CPU_STAT_SS32 = sdp->d;
 	CPU_SS = (UINT16)((selector & ~3) | (cpl & 3));
 	CPU_SS_DESC = *sdp;
+	SS_UPDATE_FLAT32();
 }
 
 /*
@@ -299,6 +304,7 @@ load_descriptor(descriptor_t *sdp, UINT32 addr)
 			break;
 		}
 	}
+	SEG_UPDATE_FLAT(sdp);
 #if defined(DEBUG)
 	segdesc_dump(sdp);
 #endif
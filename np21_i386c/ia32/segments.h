@@ -70,6 +70,7 @@ typedef struct {
 #define	CPU_DESC_FLAG_READABLE	(1 << 0)
 #define	CPU_DESC_FLAG_WRITABLE	(1 << 1)
 #define	CPU_DESC_FLAG_WHOLEADR	(1 << 2)
+#define	CPU_DESC_FLAG_FLAT	(1 << 3)	/* base 0, limit 4GB, r/w data */
 } descriptor_t;
 
 #define	SEG_IS_VALID(sdp)		((sdp)->valid)
@@ -82,6 +83,58 @@ typedef struct {
 #define	SEG_IS_WRITABLE_DATA(sdp)	((sdp)->u.seg.wr)
 #define	SEG_IS_CONFORMING_CODE(sdp)	((sdp)->u.seg.ec)
 #define	SEG_IS_EXPANDDOWN_DATA(sdp)	((sdp)->u.seg.ec)
+#define	SEG_IS_FLAT(sdp)		((sdp)->flag & CPU_DESC_FLAG_FLAT)
+
+/*
+ * flat segment: present, writable expand-up data, base 0, limit 4GB.
+ * must be refreshed whenever base/limit/type of the descriptor is changed.
+ */
+#define	SEG_UPDATE_FLAT(sdp) \
+do { \
+	if (SEG_IS_VALID(sdp) \
+	 && SEG_IS_PRESENT(sdp) \
+	 && SEG_IS_DATA(sdp) \
+	 && SEG_IS_WRITABLE_DATA(sdp) \
+	 && !SEG_IS_EXPANDDOWN_DATA(sdp) \
+	 && ((sdp)->u.seg.segbase == 0) \
+	 && ((sdp)->u.seg.limit == 0xffffffff)) { \
+		(sdp)->flag |= CPU_DESC_FLAG_FLAT; \
+	} else { \
+		(sdp)->flag &= ~CPU_DESC_FLAG_FLAT; \
+	} \
+} while (/*CONSTCOND*/0)
+
+/*
+ * flat SS with 32bit stack: stack operations go to the linear address
+ * without segment checks.  must be refreshed whenever SS or the stack
+ * size is changed.
+ */
+#define	SS_UPDATE_FLAT32() \
+do { \
+	CPU_STAT_SS_FLAT32 = \
+	    (CPU_STAT_SS32 && SEG_IS_FLAT(&CPU_SS_DESC)) ? 1 : 0; \
+} while (/*CONSTCOND*/0)
+
+/*
+ * flat 32bit state: protected mode without paging, 32bit CS with base 0
+ * and a 4GB limit, flat DS/ES and a flat 32bit stack.  Unprefixed
+ * instructions then need no address size, segment or paging checks.
+ * CPU_CLEARPREFETCH() and data segment loads set FLAT32_RECHECK, and the
+ * state is computed again at the next instruction boundary, when a far
+ * transfer or a task switch has finished updating the segments.
+ */
+#define	FLAT32_UPDATE() \
+do { \
+	CPU_STAT_FLAT32 = \
+	    (CPU_STAT_PM && !CPU_STAT_VM86 && !CPU_STAT_PAGING \
+	     && CPU_STATSAVE.cpu_inst_default.op_32 \
+	     && CPU_STATSAVE.cpu_inst_default.as_32 \
+	     && (CPU_CS_DESC.u.seg.segbase == 0) \
+	     && (CPU_CS_DESC.u.seg.limit == 0xffffffff) \
+	     && CPU_STAT_SS_FLAT32 \
+	     && SEG_IS_FLAT(&CPU_DS_DESC) \
+	     && SEG_IS_FLAT(&CPU_ES_DESC)) ? 1 : 0; \
+} while (/*CONSTCOND*/0)
 
 /*
  * segment descriptor